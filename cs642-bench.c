@@ -0,0 +1,510 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-bench.c
+//  Description    : This is the benchmark suite of the cryptanalysis project
+//                   (make bench). It encrypts seeded plaintexts cut from a
+//                   corpus with seeded keys through cs642Encrypt, so every
+//                   run analyzes the same workload, then times each analyzer
+//                   and the hot scoring kernels across ciphertext lengths and
+//                   writes the results as JSON.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <compsci642_log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-impl.h"
+#include "cs642-cryptanalysis-kernels.h"
+#include "cs642-cryptanalysis-batch.h"
+#include "cs642-cryptanalysis-model.h"
+#include "cs642-cryptanalysis-random.h"
+
+// Defines
+#define cs642_BENCH_ARGUMENTS "vhs:n:l:p:o:m:q:"
+#define cs642_BENCH_USAGE                                                      \
+  "\n"                                                                         \
+  "  cs642-bench [-v] [-h] [-s <seed>] [-n <runs>] [-l <len>,...]\n"           \
+  "              [-p <corpus>] [-o <file>] [-m <model>] [-q <mode>]\n\n"      \
+  "  where:\n"                                                                 \
+  "     -s - seed of the plaintexts and keys (default 642)\n"                  \
+  "     -n - analyses per cipher and length (default 5)\n"                     \
+  "     -l - ciphertext lengths (default " BENCH_LENGTHS ")\n"                \
+  "     -p - corpus the plaintexts are cut from (default " BENCH_CORPUS ")\n"  \
+  "     -o - the JSON results file (default stdout)\n"                         \
+  "     -m - language model file (default " CS642_MODEL_FILE ")\n"            \
+  "     -q - n-gram scoring mode (float, the default, or fixed)\n"            \
+  "     -v - verbose mode (display progress messages)\n"                       \
+  "     -h - displays this help message, and returns\n\n"
+#define BENCH_SEED 642
+#define BENCH_RUNS 5
+#define BENCH_LENGTHS "50,200,1000,10000,100000,1000000"
+#define BENCH_CORPUS "pg11.txt"
+#define BENCH_MAX_LENGTHS 16
+#define BENCH_SUBS_MAX_LENGTH 10000  // longer substitution searches take minutes
+#define BENCH_KERNEL_BYTES (1 << 22) // text each kernel scans per length
+#define BENCH_MIN_VIGE_KEY 6         // the default Vigenere key length search
+#define BENCH_MAX_VIGE_KEY 11
+#define BENCH_MAX_KEY 32
+
+//
+// Type definitions
+
+// the timings of the runs of one benchmark
+typedef struct benchstats {
+  double *latencies;          // ms of each run
+  int runs;
+  int solved;                 // runs that recovered the plaintext
+  double iterations;          // search iterations summed over the solved runs
+  double total;               // ms of all the runs
+} BenchStats;
+
+//
+// Global Data
+int cs642Verbose = 0;
+uint32_t CipherVerboseLevel;
+
+static const char *benchCipherNames[] = {"ROTX", "VIGE", "SUBS"};
+static int benchResults = 0; // results written so far, for the separators
+
+//
+// Functions
+
+// get the time of a monotonic clock in ms
+static double benchNow(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+// order latencies for the percentiles
+static int compareLatency(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// get the latency under which a share p of the sorted runs completed
+static double percentile(const double *sorted, int n, double p) {
+  int i = (int)(p * n + 0.999999) - 1;
+  return sorted[i < 0 ? 0 : i];
+}
+
+// read a corpus normalized to A-Z with every run of other characters as a
+// single space, the shape of the sample ciphertexts
+static char *loadCorpus(const char *path, size_t *length) {
+  FILE *in = fopen(path, "rb");
+  char *corpus;
+  size_t n = 0, size = 1 << 16;
+  int ch, last = ' ';
+
+  if (in == NULL) return NULL;
+  if ((corpus = malloc(size)) == NULL) {
+    fclose(in);
+    return NULL;
+  }
+  while ((ch = fgetc(in)) != EOF) {
+    if (ch >= 'a' && ch <= 'z') ch -= 'a' - 'A';
+    else if (ch < 'A' || ch > 'Z') ch = ' ';
+    if (ch == ' ' && last == ' ') continue;
+    if (n + 1 == size) {
+      char *grown = realloc(corpus, size *= 2);
+      if (grown == NULL) {
+        free(corpus);
+        fclose(in);
+        return NULL;
+      }
+      corpus = grown;
+    }
+    corpus[n++] = last = ch;
+  }
+  fclose(in);
+  corpus[n] = '\0';
+  *length = n;
+  return corpus;
+}
+
+// cut a plaintext of the given length from the corpus, from a seeded word to
+// the last whole word, wrapping around if the corpus is too short
+static void cutPlaintext(const char *corpus, size_t clen, int length,
+                         cs642Random *rng, char *ptext) {
+  size_t off = cs642RandomBelow(rng, (uint32_t)clen);
+  int i;
+
+  while (off < clen && corpus[off] != ' ') off++;
+  for (i = 0; i < length; i++) {
+    off = (off + 1) % clen;
+    ptext[i] = corpus[off];
+  }
+  ptext[length] = '\0';
+
+  // blank a last word cut short, it would never be found in the dictionary
+  if (corpus[(off + 1) % clen] != ' ' && memchr(ptext, ' ', length) != NULL) {
+    for (i = length - 1; ptext[i] != ' '; i--) ptext[i] = ' ';
+  }
+}
+
+// draw a seeded key of a cipher, returning its length
+static int drawKey(cs642Cipher cipher, cs642Random *rng, char *key) {
+  int i, j, keylen;
+  char c;
+
+  switch (cipher) {
+  case CIPHER_ROTX:
+    key[0] = 1 + cs642RandomBelow(rng, 25);
+    keylen = 1;
+    break;
+  case CIPHER_VIGE:
+    keylen = BENCH_MIN_VIGE_KEY + cs642RandomBelow(rng, BENCH_MAX_VIGE_KEY - BENCH_MIN_VIGE_KEY + 1);
+    for (i = 0; i < keylen; i++) key[i] = 'A' + cs642RandomBelow(rng, 26);
+    break;
+  default:
+    keylen = 26;
+    for (i = 0; i < keylen; i++) key[i] = 'A' + i;
+    for (i = keylen - 1; i > 0; i--) {
+      j = cs642RandomBelow(rng, i + 1);
+      c = key[i];
+      key[i] = key[j];
+      key[j] = c;
+    }
+    break;
+  }
+  key[keylen] = '\0';
+  return keylen;
+}
+
+// write a string as a JSON string literal, escaping quotes, backslashes and
+// control characters
+static void emitJsonString(FILE *out, const char *str) {
+  const unsigned char *c;
+
+  fputc('"', out);
+  for (c = (const unsigned char *)str; *c; c++) {
+    if (*c == '"' || *c == '\\') fprintf(out, "\\%c", *c);
+    else if (*c < 0x20) fprintf(out, "\\u%04x", *c);
+    else fputc(*c, out);
+  }
+  fputc('"', out);
+}
+
+// write one benchmark result as a JSON object
+static void emitResult(FILE *out, const char *name, const char *kind,
+                       int length, BenchStats *stats, int analyzer) {
+  qsort(stats->latencies, stats->runs, sizeof(double), compareLatency);
+  fprintf(out, "%s\n    {\"name\": \"%s\", \"kind\": \"%s\", \"length\": %d, "
+               "\"runs\": %d, \"ops_per_sec\": %.3f, \"mb_per_sec\": %.3f, "
+               "\"p50_ms\": %.6f, \"p99_ms\": %.6f",
+          benchResults++ ? "," : "", name, kind, length, stats->runs,
+          stats->runs / (stats->total / 1e3),
+          (double)length * stats->runs / (stats->total / 1e3) / 1e6,
+          percentile(stats->latencies, stats->runs, 0.5),
+          percentile(stats->latencies, stats->runs, 0.99));
+  // the iterations to solve are only averaged over the solved runs
+  if (analyzer) {
+    fprintf(out, ", \"success_rate\": %.3f, \"iterations\": ",
+            (double)stats->solved / stats->runs);
+    if (stats->solved) fprintf(out, "%.1f", stats->iterations / stats->solved);
+    else fprintf(out, "null");
+  }
+  fprintf(out, "}");
+  fflush(out);
+}
+
+// encrypt and analyze seeded workloads of one cipher and length
+static int benchAnalyzer(FILE *out, cs642Cipher cipher, const char *corpus,
+                         size_t clen, int length, int runs, unsigned int seed) {
+  char *ptext = malloc(length + 1), *ctext = malloc(length + 1);
+  char *plaintext = malloc(length + 1);
+  char key[BENCH_MAX_KEY + 1], found[BENCH_MAX_KEY + 1];
+  BenchStats stats = {calloc(runs, sizeof(double)), 0, 0, 0, 0};
+  cs642Random rng;
+  double start;
+  int i, keylen, status, r = -1;
+
+  // each cipher and length gets its own workload, whatever else is run
+  cs642SeedRandom(&rng, seed + cipher * 7919u + length * 31u);
+  if (ptext == NULL || ctext == NULL || plaintext == NULL || stats.latencies == NULL)
+    goto cleanup;
+  for (i = 0; i < runs; i++) {
+    cutPlaintext(corpus, clen, length, &rng, ptext);
+    keylen = drawKey(cipher, &rng, key);
+    if (cs642Encrypt(cipher, key, keylen, ptext, length, ctext, length)) {
+      logMessage(LOG_ERROR_LEVEL, "Encrypting the %s workload failed.", benchCipherNames[cipher]);
+      goto cleanup;
+    }
+    ctext[length] = '\0';
+    memset(plaintext, 0x00, length + 1);
+    memset(found, 0x00, sizeof(found));
+
+    start = benchNow();
+    status = cs642AnalyzeCiphertext(cipher, ctext, length, plaintext, found);
+    stats.latencies[i] = benchNow() - start;
+    stats.total += stats.latencies[i];
+    if (status == 0 && memcmp(plaintext, ptext, length) == 0) {
+      stats.iterations += cs642AnalysisIterations();
+      stats.solved++;
+    }
+    stats.runs++;
+  }
+  emitResult(out, benchCipherNames[cipher], "analyzer", length, &stats, 1);
+  logMessage(LOG_INFO_LEVEL, "%s, %d chars: %d/%d solved, %.3f ms per analysis.",
+             benchCipherNames[cipher], length, stats.solved, runs, stats.total / runs);
+  r = 0;
+
+cleanup:
+  free(ptext);
+  free(ctext);
+  free(plaintext);
+  free(stats.latencies);
+  return r;
+}
+
+// time the scoring kernels on a seeded plaintext of one length, repeating
+// each call until BENCH_KERNEL_BYTES of text were scanned
+static int benchKernels(FILE *out, const char *corpus, size_t clen,
+                        const double expected[KERNEL_NALPHA], int length,
+                        int runs, unsigned int seed) {
+  int reps = BENCH_KERNEL_BYTES / length > runs ? BENCH_KERNEL_BYTES / length : runs;
+  char *ptext = malloc(length + 1), *words = malloc(length + 1);
+  uint8_t *letters = malloc(length + 1);
+  char **word = malloc((length / 2 + 1) * sizeof(char *));
+  BenchStats stats = {calloc(reps, sizeof(double)), reps, 0, 0, 0};
+  uint32_t counts[KERNEL_NALPHA];
+  double chi[KERNEL_NALPHA], start, sink = 0;
+  cs642Random rng;
+  int i, j, n, nwords = 0, matches = 0, r = -1;
+
+  if (!ptext || !words || !letters || !word || !stats.latencies) goto cleanup;
+  cs642SeedRandom(&rng, seed + length * 31u);
+  cutPlaintext(corpus, clen, length, &rng, ptext);
+  normalizeLetters(ptext, length, letters);
+
+  // split a copy into the words checkDictionary takes
+  memcpy(words, ptext, length + 1);
+  for (i = 0; i < length; i++) {
+    if (words[i] == ' ') words[i] = '\0';
+    else if (i == 0 || words[i - 1] == '\0') word[nwords++] = &words[i];
+  }
+
+  // the Chi-squared of every shift, from one letter histogram of the text
+  for (i = 0, stats.total = 0; i < reps; i++) {
+    start = benchNow();
+    letterHistogram(letters, length, 0, counts);
+    chiSquaredShifts(counts, expected, chi);
+    stats.latencies[i] = benchNow() - start;
+    stats.total += stats.latencies[i];
+    sink += chi[0];
+  }
+  emitResult(out, "chiSquared", "kernel", length, &stats, 0);
+
+  // the 4-gram log probability sum of the text
+  for (i = 0, stats.total = 0; i < reps; i++) {
+    start = benchNow();
+    sink += cipherNGPSum(ptext, &n);
+    stats.latencies[i] = benchNow() - start;
+    stats.total += stats.latencies[i];
+  }
+  emitResult(out, "cipherNGPSum", "kernel", length, &stats, 0);
+
+  // the dictionary lookup of every word of the text
+  for (i = 0, stats.total = 0; i < reps; i++) {
+    start = benchNow();
+    for (j = 0; j < nwords; j++) checkDictionary(word[j], &matches);
+    stats.latencies[i] = benchNow() - start;
+    stats.total += stats.latencies[i];
+  }
+  emitResult(out, "checkDictionary", "kernel", length, &stats, 0);
+  logMessage(LOG_INFO_LEVEL, "Kernels, %d chars: %d reps (%.0f, %d).", length,
+             reps, sink, matches);
+  r = 0;
+
+cleanup:
+  free(ptext);
+  free(words);
+  free(letters);
+  free(word);
+  free(stats.latencies);
+  return r;
+}
+
+// get the letter probabilities of a corpus, the expected Chi-squared counts
+static void corpusLetterProbs(const char *corpus, size_t clen,
+                              double expected[KERNEL_NALPHA]) {
+  size_t i, total = 0;
+  int c;
+
+  memset(expected, 0, KERNEL_NALPHA * sizeof(double));
+  for (i = 0; i < clen; i++) {
+    if (corpus[i] != ' ') {
+      expected[corpus[i] - 'A']++;
+      total++;
+    }
+  }
+  for (c = 0; c < KERNEL_NALPHA; c++) {
+    expected[c] = total ? expected[c] / total : 1.0 / KERNEL_NALPHA;
+  }
+}
+
+// parse a comma separated list of lengths, returning how many were read
+static int parseLengths(char *list, int lengths[BENCH_MAX_LENGTHS]) {
+  char *tok, *end, *save = NULL;
+  int n = 0;
+  long v;
+
+  for (tok = strtok_r(list, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+    v = strtol(tok, &end, 10);
+    if (*end || v < 1 || v > 100000000 || n == BENCH_MAX_LENGTHS) return -1;
+    lengths[n++] = (int)v;
+  }
+  return n > 0 ? n : -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : main
+// Description  : The main function for the benchmark suite
+//
+// Inputs       : argc - the number of command line parameters
+//                argv - the parameters
+// Outputs      : 0 if successful, -1 if failure
+
+int main(int argc, char *argv[]) {
+
+  // Local variables
+  int ch, i, c, nlengths, lengths[BENCH_MAX_LENGTHS], runs = BENCH_RUNS;
+  unsigned int seed = BENCH_SEED;
+  char lengthList[] = BENCH_LENGTHS, *lengthArg = lengthList;
+  const char *corpusPath = BENCH_CORPUS, *outPath = NULL;
+  const char *modelPath = CS642_MODEL_FILE;
+  cs642ScoreMode scoreMode = CS642_SCORE_FLOAT;
+  double expected[KERNEL_NALPHA];
+  char *corpus;
+  size_t clen;
+  FILE *out = stdout;
+  int r = 0;
+
+  // Process the command line parameters
+  while ((ch = getopt(argc, argv, cs642_BENCH_ARGUMENTS)) != -1) {
+    switch (ch) {
+    case 'v': // Verbose Flag
+      cs642Verbose = 1;
+      break;
+
+    case 's': // Workload seed
+      seed = (unsigned int)strtoul(optarg, NULL, 10);
+      break;
+
+    case 'n': // Runs per cipher and length
+      if ((runs = atoi(optarg)) < 1) {
+        fprintf(stderr, "Bad number of runs (%s), aborting.\n", optarg);
+        return (-1);
+      }
+      break;
+
+    case 'l': // Ciphertext lengths
+      lengthArg = optarg;
+      break;
+
+    case 'p': // Plaintext corpus
+      corpusPath = optarg;
+      break;
+
+    case 'o': // Results file
+      outPath = optarg;
+      break;
+
+    case 'm': // Language model file
+      modelPath = optarg;
+      break;
+
+    case 'q': // Scoring mode
+      for (scoreMode = CS642_SCORE_FLOAT; scoreMode < CS642_SCORE_MAX; scoreMode++) {
+        if (strcmp(optarg, cs642ScoreModeStrings[scoreMode]) == 0)
+          break;
+      }
+      if (scoreMode == CS642_SCORE_MAX) {
+        fprintf(stderr, "Unknown scoring mode (%s), aborting.\n", optarg);
+        return (-1);
+      }
+      break;
+
+    case 'h': // Help Flag
+      fprintf(stderr, cs642_BENCH_USAGE);
+      return (0);
+
+    default: // Default (unknown)
+      fprintf(stderr, "Unknown command line option (%c), aborting.\n", ch);
+      return (-1);
+    }
+  }
+  if ((nlengths = parseLengths(lengthArg, lengths)) < 0) {
+    fprintf(stderr, "Bad ciphertext lengths (%s), aborting.\n", lengthArg);
+    return (-1);
+  }
+
+  // Setup the log as needed, the results may go to stdout
+  initializeLogWithFilehandle(COMPSCI642_LOG_STDERR);
+  CipherVerboseLevel = registerLogLevel("CipherVerboseLevel", 0);
+  if (cs642Verbose) {
+    enableLogLevels(LOG_INFO_LEVEL);
+  }
+
+  if ((corpus = loadCorpus(corpusPath, &clen)) == NULL || clen == 0) {
+    logMessage(LOG_ERROR_LEVEL, "Cannot read corpus (%s), aborting.", corpusPath);
+    free(corpus);
+    return (-1);
+  }
+  corpusLetterProbs(corpus, clen, expected);
+  if (outPath != NULL && (out = fopen(outPath, "w")) == NULL) {
+    logMessage(LOG_ERROR_LEVEL, "Cannot create results file (%s), aborting.", outPath);
+    free(corpus);
+    return (-1);
+  }
+
+  // Set up the dictionary and model once, as the cryptanalysis program does
+  cs642StartProject();
+  cs642SetModelFile(modelPath);
+  // every run must search, a cached result would only time the lookup, and
+  // the searches are seeded from the workload seed so runs are repeatable
+  cs642SetCache(0, NULL);
+  cs642SetSUBSSeed(seed);
+  cs642SetScoreMode(scoreMode);
+  if (cs642StudentInit()) {
+    logMessage(LOG_ERROR_LEVEL, "cs642StudentInit failed, aborting.");
+    free(corpus);
+    return (-1);
+  }
+
+  fprintf(out, "{\n  \"seed\": %u, \"runs\": %d, \"corpus\": ", seed, runs);
+  emitJsonString(out, corpusPath);
+  fprintf(out, ", \"model\": ");
+  emitJsonString(out, modelPath);
+  fprintf(out, ", \"score_mode\": \"%s\", \"histogram_kernel\": \"%s\",\n  \"results\": [",
+          cs642ScoreModeStrings[scoreMode], kernelsName());
+  for (i = 0; i < nlengths && r == 0; i++) {
+    for (c = CIPHER_ROTX; c <= CIPHER_SUBS && r == 0; c++) {
+      if (c == CIPHER_SUBS && lengths[i] > BENCH_SUBS_MAX_LENGTH) {
+        logMessage(LOG_INFO_LEVEL, "SUBS, %d chars: skipped, over %d chars.",
+                   lengths[i], BENCH_SUBS_MAX_LENGTH);
+        continue;
+      }
+      r = benchAnalyzer(out, c, corpus, clen, lengths[i], runs, seed);
+    }
+    if (r == 0) r = benchKernels(out, corpus, clen, expected, lengths[i], runs, seed);
+  }
+  fprintf(out, "\n  ]\n}\n");
+
+  if (out != stdout) fclose(out);
+  free(corpus);
+  cs642CleanCipherStructures();
+  cs642StudentCleanUp();
+  return (r);
+}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-buildmodel.c
+//  Description    : This is the offline builder of the language model file
+//                   mapped by the cryptanalysis program (make model). The
+//                   model is counted from the text corpora given, or from
+//                   the dictionary words if there are none.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <compsci642_log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-model.h"
+
+// Defines
+#define cs642_BUILDMODEL_ARGUMENTS "vho:"
+#define cs642_BUILDMODEL_USAGE                                                 \
+  "\n"                                                                         \
+  "  cs642-buildmodel [-v] [-h] [-o <file>] [corpus ...]\n\n"                  \
+  "  where:\n"                                                                 \
+  "     -o - the model file to write (default " CS642_MODEL_FILE ")\n"         \
+  "     corpus - text files to count, - for stdin (default the dictionary)\n"  \
+  "     -v - verbose mode (display all logging messages)\n"                    \
+  "     -h - displays this help message, and returns\n\n"
+
+//
+// Global Data
+int cs642Verbose = 0;
+uint32_t CipherVerboseLevel;
+
+//
+// Functions
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : main
+// Description  : The main function for the model builder
+//
+// Inputs       : argc - the number of command line parameters
+//                argv - the parameters
+// Outputs      : 0 if successful, -1 if failure
+
+int main(int argc, char *argv[]) {
+
+  // Local variables
+  int ch;
+  const char *path = CS642_MODEL_FILE;
+  cs642Model model;
+
+  // Process the command line parameters
+  while ((ch = getopt(argc, argv, cs642_BUILDMODEL_ARGUMENTS)) != -1) {
+    switch (ch) {
+    case 'v': // Verbose Flag
+      cs642Verbose = 1;
+      break;
+
+    case 'o': // Model file
+      path = optarg;
+      break;
+
+    case 'h': // Help Flag
+      fprintf(stderr, cs642_BUILDMODEL_USAGE);
+      return (0);
+
+    default: // Default (unknown)
+      fprintf(stderr, "Unknown command line option (%c), aborting.\n", ch);
+      return (-1);
+    }
+  }
+
+  // Setup the log as needed
+  initializeLogWithFilehandle(COMPSCI642_LOG_STDOUT);
+  CipherVerboseLevel = registerLogLevel("CipherVerboseLevel", 0);
+  if (cs642Verbose) {
+    enableLogLevels(LOG_INFO_LEVEL);
+    enableLogLevels(CipherVerboseLevel);
+  }
+
+  // Count the corpora, or the dictionary, and write the tables out
+  cs642StartProject();
+  if ((optind < argc ? cs642BuildCorpusModel(&model, &argv[optind], argc - optind)
+                     : cs642BuildModel(&model)) ||
+      cs642WriteModel(&model, path)) {
+    logMessage(LOG_ERROR_LEVEL, "Building the model failed, aborting.");
+    return (-1);
+  }
+  logMessage(LOG_OUTPUT_LEVEL, "Wrote language model (%s), %zu bytes.", path,
+             model.size);
+  cs642FreeModel(&model);
+  cs642CleanCipherStructures();
+  return (0);
+}
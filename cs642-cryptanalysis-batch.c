@@ -0,0 +1,356 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-batch.c
+//  Description    : This is the batch mode of the cryptanalysis program. It
+//                   reads newline or length delimited ciphertexts, each
+//                   optionally tagged with its cipher, runs the analyzer for
+//                   the cipher on a thread pool and streams the results to
+//                   stdout as CSV, in input order.
+//                   The dictionary and models are set up once by the caller,
+//                   so each record only costs its own analysis.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <compsci642_log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-impl.h"
+#include "cs642-cryptanalysis-batch.h"
+#include "cs642-cryptanalysis-stats.h"
+
+//
+// Defines
+
+#define BATCH_CSV_HEADER "cipher,key,plaintext,score,latency"
+#define BATCH_MAX_TAG 16
+#define BATCH_JOBS_PER_WORKER 4 // records in flight per pool worker
+#define BATCH_ACCEPT_SHARE 0.5  // dictionary word share of a solved record
+#define BATCH_END -1            // readRecord results other than a length
+#define BATCH_BAD_RECORD -2
+
+//
+// Type definitions
+
+// one record of a batch and its result, the buffers are reused by the
+// records that later take the same slot of the window
+typedef struct batchjob {
+  cs642Task task;
+  cs642Cipher cipher;
+  char *ciphertext;           // the record, as read
+  size_t textSize;
+  int clen;
+  char *plaintext;
+  size_t plainSize;
+  char *key;
+  int keySize;
+  int status;
+  double score;
+  double latency;             // ms spent in the analyzer
+} BatchJob;
+
+//
+// Global Data
+
+// The short cipher tags used on input and output records
+static const char *batchCipherTags[] = {"ROTX", "VIGE", "SUBS", "UNK"};
+
+//
+// Functions
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642ParseCipher
+// Description  : Parse a cipher tag, either the short tag or the full name
+//                of the cipher, ignoring case
+//
+// Inputs       : name - the tag to parse
+//                cipher - the place to put the cipher
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642ParseCipher(const char *name, cs642Cipher *cipher) {
+  cs642Cipher c;
+
+  for (c = CIPHER_ROTX; c < CIPHER_MAX; c++) {
+    if (strcasecmp(name, batchCipherTags[c]) == 0 ||
+        (c < CIPHER_UNK && strcasecmp(name, cs642CipherStrings[c]) == 0)) {
+      *cipher = c;
+      return (0);
+    }
+  }
+  return (-1);
+}
+
+// split an optional "TAG:" prefix off a record, returning the rest of it
+static char *splitCipherTag(char *record, cs642Cipher *cipher) {
+  char tag[BATCH_MAX_TAG];
+  char *colon = strchr(record, ':');
+  int n;
+
+  if (colon == NULL || (n = colon - record) >= BATCH_MAX_TAG) return record;
+  memcpy(tag, record, n);
+  tag[n] = '\0';
+  if (cs642ParseCipher(tag, cipher)) return record;
+  return colon + 1;
+}
+
+// read the next record into *buf, returning its length, BATCH_END at the end
+// of the input or BATCH_BAD_RECORD if a record cannot be read
+static int readRecord(FILE *in, cs642BatchConfig *config, char **buf,
+                      size_t *size, cs642Cipher *cipher) {
+  ssize_t n;
+  long len;
+  char *text, *end;
+  int ch;
+
+  *cipher = config->defaultCipher;
+  while ((n = getline(buf, size, in)) >= 0) {
+    while (n > 0 && ((*buf)[n - 1] == '\n' || (*buf)[n - 1] == '\r'))
+      (*buf)[--n] = '\0';
+    if (n == 0) continue;
+    text = splitCipherTag(*buf, cipher);
+
+    if (!config->lengthDelimited) {
+      n -= text - *buf;
+      memmove(*buf, text, n + 1);
+      return (int)n;
+    }
+
+    // the header line holds the length of the ciphertext bytes that follow
+    len = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || len < 0 || len > (1L << 30)) {
+      logMessage(LOG_ERROR_LEVEL, "Bad batch record length [%s].", text);
+      return (BATCH_BAD_RECORD);
+    }
+    if ((size_t)len + 1 > *size) {
+      char *grown = realloc(*buf, len + 1);
+      if (grown == NULL) return (BATCH_BAD_RECORD);
+      *buf = grown;
+      *size = len + 1;
+    }
+    if (fread(*buf, 1, len, in) != (size_t)len) {
+      logMessage(LOG_ERROR_LEVEL, "Truncated batch record of %ld bytes.", len);
+      return (BATCH_BAD_RECORD);
+    }
+    (*buf)[len] = '\0';
+    // an optional newline separates a record from the next header
+    if ((ch = fgetc(in)) != '\n' && ch != EOF) ungetc(ch, in);
+    return (int)len;
+  }
+  return (BATCH_END);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642AnalyzeCiphertext
+// Description  : Run the analyzer for a cipher, the analyzers keep all their
+//                state on the stack or in buffers of their own, so this is
+//                safe to call from several threads at once
+//
+// Inputs       : cipher - the cipher of the ciphertext
+//                ciphertext - the ciphertext to analyze
+//                clen - the length of the ciphertext
+//                plaintext - the place to put the plaintext, clen + 1 bytes
+//                key - the place to put the key
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642AnalyzeCiphertext(cs642Cipher cipher, char *ciphertext, int clen,
+                           char *plaintext, char *key) {
+  switch (cipher) {
+  case CIPHER_ROTX:
+    return cs642PerformROTXCryptanalysis(ciphertext, clen, plaintext, clen,
+                                         (uint8_t *)key);
+  case CIPHER_VIGE:
+    return cs642PerformVIGECryptanalysis(ciphertext, clen, plaintext, clen, key);
+  case CIPHER_SUBS:
+    return cs642PerformSUBSCryptanalysis(ciphertext, clen, plaintext, clen, key);
+  default:
+    logMessage(LOG_ERROR_LEVEL, "Unknown cipher (%d) in cryptanalysis.", cipher);
+    return (-1);
+  }
+}
+
+// run the analyzer of one cipher on a record, from cleared buffers
+static int analyzeBatchJob(BatchJob *job, cs642Cipher cipher) {
+  memset(job->plaintext, 0x00, job->clen + 1);
+  memset(job->key, 0x00, job->keySize + 1);
+  return cs642AnalyzeCiphertext(cipher, job->ciphertext, job->clen,
+                                job->plaintext, job->key);
+}
+
+// classify an unlabeled record and run the analyzers from the most likely
+// one, falling back to the next until a plaintext reads as English, if none
+// does the record keeps the result of the most likely cipher
+static int analyzeUnknownJob(BatchJob *job) {
+  int i, r, status;
+  char *plaintext = NULL, *key = NULL;
+  cs642Cipher order[CIPHER_UNK];
+
+  cs642ClassifyCiphertext(job->ciphertext, job->clen, order);
+  job->cipher = order[0];
+  status = analyzeBatchJob(job, order[0]);
+  if (status == 0 && cs642DictWordShare(job->plaintext) >= BATCH_ACCEPT_SHARE)
+    return (0);
+
+  // keep the first result aside while the fallbacks run
+  plaintext = malloc(job->clen + 1);
+  key = malloc(job->keySize + 1);
+  if (plaintext == NULL || key == NULL) {
+    free(plaintext);
+    free(key);
+    return (status);
+  }
+  memcpy(plaintext, job->plaintext, job->clen + 1);
+  memcpy(key, job->key, job->keySize + 1);
+  for (i = 1; i < CIPHER_UNK; i++) {
+    r = analyzeBatchJob(job, order[i]);
+    if (r == 0 && cs642DictWordShare(job->plaintext) >= BATCH_ACCEPT_SHARE) {
+      job->cipher = order[i];
+      status = 0;
+      break;
+    }
+  }
+  if (i == CIPHER_UNK) {
+    memcpy(job->plaintext, plaintext, job->clen + 1);
+    memcpy(job->key, key, job->keySize + 1);
+  }
+  free(plaintext);
+  free(key);
+  return (status);
+}
+
+// analyze one batch record, run on a pool worker
+static void runBatchJob(void *arg) {
+  BatchJob *job = arg;
+  struct timespec start, end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (job->cipher == CIPHER_UNK)
+    job->status = analyzeUnknownJob(job);
+  else
+    job->status = analyzeBatchJob(job, job->cipher);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  job->latency = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+  job->score = cs642ScorePlaintext(job->plaintext);
+  // the pool workers exit without a chance to flush later
+  cs642FlushStats();
+}
+
+// get the buffers of a job ready for a record of clen bytes
+static int prepareBatchJob(BatchJob *job, int clen, int keySize) {
+  if ((size_t)clen + 1 > job->plainSize) {
+    free(job->plaintext);
+    job->plainSize = clen + 1;
+    job->plaintext = malloc(job->plainSize);
+    if (job->plaintext == NULL) {
+      job->plainSize = 0;
+      return -1;
+    }
+  }
+  if (job->key == NULL && (job->key = malloc(keySize + 1)) == NULL) return -1;
+
+  // the analyzers normalize the record themselves, keeping its case and
+  // punctuation on the plaintext
+  job->clen = clen;
+  job->keySize = keySize;
+  job->task.run = runBatchJob;
+  job->task.arg = job;
+  return 0;
+}
+
+// write a CSV field, quoted with its quotes doubled if it holds a comma,
+// quote or line break
+static void writeCsvField(const char *field) {
+  if (strpbrk(field, ",\"\r\n") == NULL) {
+    fputs(field, stdout);
+    return;
+  }
+  putchar('"');
+  for (; *field; field++) {
+    if (*field == '"') putchar('"');
+    putchar(*field);
+  }
+  putchar('"');
+}
+
+// wait for a job and write its CSV record, returning its status
+static int emitBatchJob(cs642Pool *pool, BatchJob *job) {
+  cs642WaitTask(pool, &job->task);
+
+  // the ROT-X key is a single byte rotation, the others are letters
+  if (job->cipher == CIPHER_ROTX)
+    printf("%s,%d,", batchCipherTags[job->cipher], (uint8_t)job->key[0]);
+  else
+    printf("%s,%s,", batchCipherTags[job->cipher], job->key);
+  writeCsvField(job->plaintext);
+  printf(",%.4f,%.3f\n", job->score, job->latency);
+  fflush(stdout);
+  return job->status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642RunBatch
+// Description  : Analyze every record of an input stream on the pool,
+//                writing a CSV record with the cipher, key, plaintext, score
+//                and latency (ms) of each ciphertext to stdout. Up to
+//                BATCH_JOBS_PER_WORKER records per worker are in flight, and
+//                records are written in input order as soon as every record
+//                before them is done.
+//
+// Inputs       : in - the stream to read records from
+//                config - the batch settings
+// Outputs      : the number of records that failed, -1 if the input is bad
+
+int cs642RunBatch(FILE *in, cs642BatchConfig *config) {
+  BatchJob *jobs, *job;
+  int i, clen, window, head = 0, inflight = 0, failed = 0;
+
+  window = cs642PoolWorkers(config->pool) * BATCH_JOBS_PER_WORKER;
+  jobs = calloc(window, sizeof(BatchJob));
+  if (jobs == NULL) return (-1);
+  printf("%s\n", BATCH_CSV_HEADER);
+
+  for (;;) {
+    // retire the oldest record once the window is full, its slot is reused
+    if (inflight == window) {
+      if (emitBatchJob(config->pool, &jobs[head])) failed++;
+      head = (head + 1) % window;
+      inflight--;
+    }
+    job = &jobs[(head + inflight) % window];
+    clen = readRecord(in, config, &job->ciphertext, &job->textSize, &job->cipher);
+    // a length delimited stream cannot be resynchronized after a bad record,
+    // so the records after it are lost and the batch fails
+    if (clen == BATCH_BAD_RECORD) failed = -1;
+    if (clen < 0) break;
+    if (prepareBatchJob(job, clen, config->keySize) ||
+        cs642SubmitTask(config->pool, &job->task)) {
+      failed = -1;
+      break;
+    }
+    inflight++;
+  }
+
+  // write out the records still in flight, in order
+  for (; inflight > 0; inflight--) {
+    if (emitBatchJob(config->pool, &jobs[head]) && failed >= 0) failed++;
+    head = (head + 1) % window;
+  }
+
+  for (i = 0; i < window; i++) {
+    free(jobs[i].ciphertext);
+    free(jobs[i].plaintext);
+    free(jobs[i].key);
+  }
+  free(jobs);
+  return (failed);
+}
@@ -0,0 +1,46 @@
+#ifndef CS642_CRYPTANALYSIS_BATCH_INCLUDED
+#define CS642_CRYPTANALYSIS_BATCH_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-batch.h
+//  Description    : This is an include file to define the batch mode of the
+//                   cryptanalysis program, which streams ciphertexts from a
+//                   file or stdin through the analyzers in one process,
+//                   running them concurrently on a thread pool.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+// Include Files
+#include <stdio.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-pool.h"
+
+//
+// Type definitions
+
+// Batch mode settings
+typedef struct cs642BatchConfig {
+  cs642Cipher defaultCipher; // Cipher of records without a tag
+  int lengthDelimited;       // Records are "[TAG:]<len>\n<bytes>", not lines
+  int keySize;               // Size of the largest key an analyzer can return
+  cs642Pool *pool;           // Workers the records are analyzed on
+} cs642BatchConfig;
+
+//
+// Batch functions
+
+int cs642ParseCipher(const char *name, cs642Cipher *cipher);
+// Parse a cipher tag (ROTX, VIGE, SUBS or UNK, or its full name)
+
+int cs642AnalyzeCiphertext(cs642Cipher cipher, char *ciphertext, int clen,
+                           char *plaintext, char *key);
+// Run the analyzer of a cipher, safe to call from several threads at once
+
+int cs642RunBatch(FILE *in, cs642BatchConfig *config);
+// Analyze every record read from in on the pool, writing one CSV record per
+// ciphertext (cipher,key,plaintext,score,latency) to stdout in input order
+
+#endif
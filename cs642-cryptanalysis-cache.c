@@ -0,0 +1,382 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-cache.c
+//  Description    : This is the result cache of the cryptanalysis program.
+//                   Both the results and the known keys live in fixed tables
+//                   of entries, chained off a power of two bucket array and
+//                   threaded on a most recently used list, so a lookup is a
+//                   hash probe and a full table evicts its list tail. One
+//                   lock guards everything, it is only held for a lookup or
+//                   an insert and never across a search.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <compsci642_log.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-batch.h"
+#include "cs642-cryptanalysis-cache.h"
+
+//
+// Defines
+
+#define CACHE_KNOWN_KEYS 64    // known keys kept for each cache
+#define CACHE_MAX_LINE 256
+#define CACHE_NONE -1
+
+//
+// Type definitions
+
+// a cached result, or a known key
+typedef struct cacheentry {
+  uint64_t hash;              // hash of the ciphertext, or of the key
+  int clen;                   // length of the ciphertext, or of the key
+  cs642Cipher cipher;
+  double score;
+  char key[CS642_CACHE_KEY_MAX + 1];
+  int prev, next;             // most recently used list
+  int chain;                  // next entry of the same bucket
+} CacheEntry;
+
+// a bounded table of entries with least recently used eviction
+typedef struct cachetable {
+  CacheEntry *entries;
+  int *buckets;
+  uint32_t mask;
+  int capacity;
+  int used;
+  int head, tail;             // most and least recently used entries
+} CacheTable;
+
+//
+// Global Data
+
+static CacheTable cacheResults;
+static CacheTable cacheKeys;
+static FILE *cacheFile = NULL;
+static int cacheVigeKeyMax = 0;       // longest Vigenere key reloaded
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+// The cipher tags of the cache file records
+static const char *cacheCipherTags[] = {"ROTX", "VIGE", "SUBS", "UNK"};
+
+//
+// Functions
+
+// FNV-1a hash of a key string, mixed with its cipher
+static uint64_t keyHash(cs642Cipher cipher, const char *key) {
+  uint64_t h = 14695981039346656037ull ^ (uint64_t)cipher;
+
+  while (*key) {
+    h ^= (unsigned char)*key++;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+// allocate a table of capacity entries, all free
+static int initTable(CacheTable *table, int capacity) {
+  uint32_t i, size = 1;
+
+  while (size < (uint32_t)capacity) size <<= 1;
+  table->entries = malloc(capacity * sizeof(CacheEntry));
+  table->buckets = malloc(size * sizeof(int));
+  if (table->entries == NULL || table->buckets == NULL) return -1;
+  for (i = 0; i < size; i++) table->buckets[i] = CACHE_NONE;
+  table->mask = size - 1;
+  table->capacity = capacity;
+  table->used = 0;
+  table->head = table->tail = CACHE_NONE;
+  return 0;
+}
+
+// release a table
+static void freeTable(CacheTable *table) {
+  free(table->entries);
+  free(table->buckets);
+  memset(table, 0, sizeof(CacheTable));
+}
+
+// take an entry off the most recently used list
+static void unlinkEntry(CacheTable *table, int e) {
+  CacheEntry *entry = &table->entries[e];
+
+  if (entry->prev != CACHE_NONE) table->entries[entry->prev].next = entry->next;
+  else table->head = entry->next;
+  if (entry->next != CACHE_NONE) table->entries[entry->next].prev = entry->prev;
+  else table->tail = entry->prev;
+}
+
+// put an entry at the front of the most recently used list
+static void pushEntry(CacheTable *table, int e) {
+  CacheEntry *entry = &table->entries[e];
+
+  entry->prev = CACHE_NONE;
+  entry->next = table->head;
+  if (table->head != CACHE_NONE) table->entries[table->head].prev = e;
+  table->head = e;
+  if (table->tail == CACHE_NONE) table->tail = e;
+}
+
+// find the entry of a hash, moving it to the front, CACHE_NONE if missing
+static int findEntry(CacheTable *table, cs642Cipher cipher, uint64_t hash, int clen) {
+  int e;
+
+  for (e = table->buckets[hash & table->mask]; e != CACHE_NONE; e = table->entries[e].chain) {
+    if (table->entries[e].hash == hash && table->entries[e].cipher == cipher &&
+        table->entries[e].clen == clen) {
+      unlinkEntry(table, e);
+      pushEntry(table, e);
+      return e;
+    }
+  }
+  return CACHE_NONE;
+}
+
+// get the entry of a hash, adding it in place of the least recently used
+// entry if it is missing and the table is full
+static int addEntry(CacheTable *table, cs642Cipher cipher, uint64_t hash, int clen) {
+  int e, *link;
+
+  if ((e = findEntry(table, cipher, hash, clen)) != CACHE_NONE) return e;
+  if (table->used < table->capacity) {
+    e = table->used++;
+  } else {
+    // evict the tail, unchaining it from its bucket
+    e = table->tail;
+    unlinkEntry(table, e);
+    for (link = &table->buckets[table->entries[e].hash & table->mask]; *link != e;
+         link = &table->entries[*link].chain);
+    *link = table->entries[e].chain;
+  }
+  table->entries[e].hash = hash;
+  table->entries[e].cipher = cipher;
+  table->entries[e].clen = clen;
+  table->entries[e].chain = table->buckets[hash & table->mask];
+  table->buckets[hash & table->mask] = e;
+  pushEntry(table, e);
+  return e;
+}
+
+// cache a result and its key, known to decrypt it with confidence
+static void storeResult(cs642Cipher cipher, uint64_t hash, int clen,
+                        const char *key, double score) {
+  CacheEntry *entry = &cacheResults.entries[addEntry(&cacheResults, cipher, hash, clen)];
+  int klen = strlen(key);
+
+  entry->score = score;
+  strcpy(entry->key, key);
+  entry = &cacheKeys.entries[addEntry(&cacheKeys, cipher, keyHash(cipher, key), klen)];
+  entry->score = score;
+  strcpy(entry->key, key);
+}
+
+// check a key read from a cache file: letters 'A'-'Z' only, a Vigenere key
+// within the configured length and a substitution key a permutation
+static int validKey(cs642Cipher cipher, const char *key) {
+  int i, len = strlen(key);
+  uint32_t seen = 0;
+
+  for (i = 0; i < len; i++) {
+    if (key[i] < 'A' || key[i] > 'Z') return 0;
+    seen |= 1u << (key[i] - 'A');
+  }
+  if (cipher == CIPHER_VIGE) return len > 0 && len <= cacheVigeKeyMax;
+  return cipher == CIPHER_SUBS && len == 26 && seen == (1u << 26) - 1;
+}
+
+// reload the results appended to a cache file, the later records winning,
+// skipping bad keys, returns the number of records read
+static int loadCacheFile(const char *path) {
+  char line[CACHE_MAX_LINE], tag[8], key[CS642_CACHE_KEY_MAX + 1];
+  uint64_t hash;
+  double score;
+  int clen, records = 0;
+  cs642Cipher cipher;
+  FILE *in = fopen(path, "r");
+
+  if (in == NULL) return 0;
+  while (fgets(line, sizeof(line), in) != NULL) {
+    if (sscanf(line, "%7s %" SCNx64 " %d %lf %64s", tag, &hash, &clen, &score,
+               key) != 5 || cs642ParseCipher(tag, &cipher) || !validKey(cipher, key))
+      continue;
+    storeResult(cipher, hash, clen, key, score);
+    records++;
+  }
+  fclose(in);
+  return records;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642InitCache
+// Description  : Set up the result cache, reloading the results of a cache
+//                file which new results are then appended to
+//
+// Inputs       : entries - the number of results kept, 0 to disable the cache
+//                path - the cache file, or NULL to keep results in memory
+//                vigeKeyMax - the longest Vigenere key reloaded from the file
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642InitCache(int entries, const char *path, int vigeKeyMax) {
+  int records;
+
+  if (entries <= 0) return (0);
+  cacheVigeKeyMax = vigeKeyMax;
+  if (initTable(&cacheResults, entries) ||
+      initTable(&cacheKeys, entries < CACHE_KNOWN_KEYS ? entries : CACHE_KNOWN_KEYS)) {
+    cs642FreeCache();
+    return (-1);
+  }
+  if (path != NULL) {
+    records = loadCacheFile(path);
+    if ((cacheFile = fopen(path, "a")) == NULL) {
+      logMessage(LOG_ERROR_LEVEL, "Cannot open cache file (%s).", path);
+      cs642FreeCache();
+      return (-1);
+    }
+    logMessage(LOG_INFO_LEVEL, "Loaded %d cached results (%s).", records, path);
+  }
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642CacheEnabled
+// Description  : Check if the result cache is set up
+//
+// Inputs       : void
+// Outputs      : 1 if results are cached, 0 if not
+
+int cs642CacheEnabled(void) {
+  return cacheResults.capacity > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642CacheHash
+// Description  : Hash a ciphertext as the analyzers see it, its letter
+//                indexes with one value for every non-letter (FNV-1a, 64
+//                bits), so texts differing only in case or punctuation share
+//                their result
+//
+// Inputs       : letters - the normalized ciphertext to hash
+//                clen - the length of the ciphertext
+// Outputs      : the hash
+
+uint64_t cs642CacheHash(const uint8_t *letters, int clen) {
+  uint64_t h = 14695981039346656037ull;
+  int i;
+
+  for (i = 0; i < clen; i++) {
+    h ^= letters[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642CacheLookup
+// Description  : Get the cached result of a ciphertext, making it the most
+//                recently used; a key longer than the caller takes is a miss
+//
+// Inputs       : cipher - the cipher of the ciphertext
+//                hash - the hash of the ciphertext
+//                clen - the length of the ciphertext
+//                key - the place to put the key in (keyMax + 1 bytes)
+//                keyMax - the longest key that fits in key
+//                score - the place to put the plaintext score in
+// Outputs      : 0 if found, -1 if not
+
+int cs642CacheLookup(cs642Cipher cipher, uint64_t hash, int clen, char *key,
+                     int keyMax, double *score) {
+  int e, len = -1;
+
+  pthread_mutex_lock(&cacheLock);
+  if ((e = findEntry(&cacheResults, cipher, hash, clen)) != CACHE_NONE &&
+      (len = strlen(cacheResults.entries[e].key)) <= keyMax) {
+    memcpy(key, cacheResults.entries[e].key, len + 1);
+    *score = cacheResults.entries[e].score;
+  }
+  pthread_mutex_unlock(&cacheLock);
+  return e == CACHE_NONE || len > keyMax ? -1 : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642CacheKnownKeys
+// Description  : Get the known keys of a cipher, the most recently used
+//                first, skipping the keys longer than the caller takes
+//
+// Inputs       : cipher - the cipher of the keys
+//                keys - the place to put the keys in
+//                max - the number of keys wanted
+//                keyMax - the longest key wanted
+// Outputs      : the number of keys put
+
+int cs642CacheKnownKeys(cs642Cipher cipher, char keys[][CS642_CACHE_KEY_MAX + 1],
+                        int max, int keyMax) {
+  int e, n = 0;
+
+  pthread_mutex_lock(&cacheLock);
+  for (e = cacheKeys.head; e != CACHE_NONE && n < max; e = cacheKeys.entries[e].next) {
+    if (cacheKeys.entries[e].cipher == cipher && (int)strlen(cacheKeys.entries[e].key) <= keyMax)
+      strcpy(keys[n++], cacheKeys.entries[e].key);
+  }
+  pthread_mutex_unlock(&cacheLock);
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642CacheStore
+// Description  : Cache the result of a ciphertext, appending it to the cache
+//                file if there is one. Only keys that decrypt their
+//                ciphertext confidently are cached, a key a stochastic search
+//                got wrong once must not be replayed
+//
+// Inputs       : cipher - the cipher of the ciphertext
+//                hash - the hash of the ciphertext
+//                clen - the length of the ciphertext
+//                key - the recovered key
+//                score - the score of the plaintext
+// Outputs      : none
+
+void cs642CacheStore(cs642Cipher cipher, uint64_t hash, int clen,
+                     const char *key, double score) {
+  if (!cs642CacheEnabled() || strlen(key) > CS642_CACHE_KEY_MAX) return;
+
+  pthread_mutex_lock(&cacheLock);
+  storeResult(cipher, hash, clen, key, score);
+  if (cacheFile != NULL) {
+    fprintf(cacheFile, "%s %016" PRIx64 " %d %.6f %s\n", cacheCipherTags[cipher],
+            hash, clen, score, key);
+    fflush(cacheFile);
+  }
+  pthread_mutex_unlock(&cacheLock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642FreeCache
+// Description  : Close the cache file and release the cache
+//
+// Inputs       : void
+// Outputs      : none
+
+void cs642FreeCache(void) {
+  if (cacheFile != NULL) fclose(cacheFile);
+  cacheFile = NULL;
+  freeTable(&cacheResults);
+  freeTable(&cacheKeys);
+}
@@ -0,0 +1,60 @@
+#ifndef CS642_CRYPTANALYSIS_CACHE_INCLUDED
+#define CS642_CRYPTANALYSIS_CACHE_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-cache.h
+//  Description    : This is an include file to define the result cache of the
+//                   cryptanalysis program. Keys that decrypted a ciphertext
+//                   with confidence are kept by the hash of the normalized
+//                   ciphertext and the cipher, with least recently used
+//                   eviction, and also on their own so they can be tried
+//                   first on new ciphertexts. The results
+//                   may be appended to a file that is reloaded at startup.
+//                   Include it after cs642-cryptanalysis-support.h.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+// Include Files
+#include <stdint.h>
+
+//
+// Defines
+
+#define CS642_CACHE_ENTRIES 4096 // default number of cached results
+#define CS642_CACHE_KEY_MAX 64   // longer keys are not cached
+
+//
+// Cache functions
+
+int cs642InitCache(int entries, const char *path, int vigeKeyMax);
+// Set up a cache of entries results (0 disables it), reloading the valid
+// keys of the file at path (Vigenere keys up to vigeKeyMax letters) and then
+// appending to it if not NULL, 0 if successful
+
+int cs642CacheEnabled(void);
+// Check if results are being cached
+
+uint64_t cs642CacheHash(const uint8_t *letters, int clen);
+// Hash the normalized letters of a ciphertext
+
+int cs642CacheLookup(cs642Cipher cipher, uint64_t hash, int clen, char *key,
+                     int keyMax, double *score);
+// Get the key and plaintext score cached for a ciphertext, 0 if found with a
+// key of at most keyMax letters
+
+int cs642CacheKnownKeys(cs642Cipher cipher, char keys[][CS642_CACHE_KEY_MAX + 1],
+                        int max, int keyMax);
+// Get up to max known keys of a cipher of at most keyMax letters, the most
+// recently used first, and return how many
+
+void cs642CacheStore(cs642Cipher cipher, uint64_t hash, int clen,
+                     const char *key, double score);
+// Cache the key and plaintext score of a ciphertext it decrypts confidently,
+// adding the key to the known keys
+
+void cs642FreeCache(void);
+// Close the cache file and release the cache
+
+#endif
@@ -15,35 +15,212 @@
 
 // Project Include Files
 #include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-impl.h"
+#include "cs642-cryptanalysis-kernels.h"
+#include "cs642-cryptanalysis-model.h"
+#include "cs642-cryptanalysis-patterns.h"
+#include "cs642-cryptanalysis-cache.h"
+#include "cs642-cryptanalysis-random.h"
+#include "cs642-cryptanalysis-stats.h"
+#include "cs642-cryptanalysis-text.h"
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <limits.h>
 #include <math.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
 
 #define MIN_KEYSIZE 6
 #define MAX_KEYSIZE 12
 #define NALPHA 26
+#define NSYMBOLS CS642_MODEL_NSYMBOLS  // the letters and the word separator
+#define WORD_SPACE CS642_MODEL_SPACE
 #define Kp 0.067
 #define Kr 0.0385
+#define VIGE_KEYSIZE_LIMIT 512
+#define VIGE_TOPK 3
+#define VIGE_REFINE_CANDIDATES 3   // best chi squared shifts tried per column
+#define VIGE_REFINE_PASSES 3       // coordinate descent passes over the key
+#define VIGE_REFINE_SAMPLE 1024    // letters decrypted to score a key
+#define NTRIGRAMS (NALPHA * NALPHA * NALPHA)
 #define NGRAMSIZE 4
-#define MAX_NGRAMS 456976
+#define NQUADGRAMS (NSYMBOLS * NSYMBOLS * NSYMBOLS * NSYMBOLS)
 #define SUBS_ITERS 10
 #define SUBS_SUBITERS 5000
+#define SUBS_MAX_THREADS 64
+#define SUBS_ANNEAL_TEMP 0.02
+#define SUBS_ANNEAL_COOLING 0.001
+#define SUBS_TABU_CANDIDATES 40
+#define SUBS_TABU_TENURE 12
+#define SUBS_CLOCK_CHECK 256
+#define SUBS_STALL_ITERS 1000      // hill climb swaps without a gain before a round ends
+#define SUBS_CONFIRM_ROUNDS 2      // rounds converging on one key make it certain
+#define SUBS_SEED_MIN_LETTERS 6    // pattern-solved letters to trust a seed
+#define CACHE_TRY_KEYS 8           // known keys tried before a search
+#define CONFIDENT_SAMPLE_WORDS 64  // words of a decryption checked for confidence
+#define CONFIDENT_MIN_WORDS 8      // fewer words than this are never certain
+#define CONFIDENT_SHARE 0.8        // dictionary share of a certain decryption
+#define DICT_LOAD_FACTOR 2
+#define CLASSIFY_ROTX_CHI 0.7      // chi-squared per letter of a shifted English text
+#define CLASSIFY_VIGE_IC ((Kp + Kr) / 2)
+#define CLASSIFY_IC_BAND 0.005     // ICs this close to the cut also check periods
+#define CLASSIFY_PERIODIC_GAIN 0.01 // column IC gain of a Vigenere key length
+
+// per-swap tracing of the SUBS search, compiled in with -DCS642_TRACE
+#ifdef CS642_TRACE
+#define TRACE_SUBS(...) logMessage(CipherVerboseLevel, __VA_ARGS__)
+#else
+#define TRACE_SUBS(...)
+#endif
 
 typedef struct lf {
   char letter;
   int freq;
 } LF;
 
-// free 2D arrays
-void freev(void **ptr, int len, int free_seg) {
-  if (len < 0) while (*ptr) { free(*ptr); *ptr++ = NULL; }
-  else { for (int i = 0; i < len; i++) free(ptr[i]); }
-  if (free_seg) free(ptr);
-}
+// open-addressing hash set over the dictionary words
+typedef struct dictentry {
+  const char *word;
+  int len;
+  int count;
+  uint32_t hash;
+} DictEntry;
+
+static DictEntry *dictIndex = NULL;
+static uint32_t dictIndexMask = 0;
+
+// scratch buffers for one analysis, allocated once per ciphertext so that the
+// decrypt and score loops never touch the heap
+typedef struct scratch {
+  char *text;                 // candidate decryption, clen + 1 bytes
+  int size;
+} Scratch;
+
+// incremental 4-gram scorer for substitution keys, rescoring only the
+// 4-grams that touch the two letters of a key swap
+typedef struct subsscorer {
+  uint8_t *text;              // ciphertext letters (0-25), and single word
+                              // separators if the model scores them
+  int *grams;                 // offsets in text of every scored 4-gram
+  int ngrams;
+  int *occ;                   // 4-gram offsets grouped by cipher letter
+  int occStart[NALPHA + 1];   // start of each cipher letter's group in occ
+  uint8_t plain[NSYMBOLS];    // cipher letter -> plaintext letter
+  const float *logProbs;      // 4-gram table of the model the search holds
+  const int16_t *fixedProbs;  // its fixed-point copy in fixed mode, else NULL
+  double fixedUnit;           // log prob of one fixed-point step
+  double score;               // 4-gram log prob sum under the current key
+  double prevScore;           // score before the last swap, for undo
+  long evals;                 // key swaps scored
+} SubsScorer;
+
+// runtime configuration of the SUBS search
+typedef struct subsconfig {
+  cs642SubsStrategy strategy;
+  int rounds;                 // restarts handed out across all chains
+  int iters;                  // key evaluations per restart
+  int timeMs;                 // wall-clock budget per ciphertext, 0 for none
+  int threads;                // parallel chains, 0 for one per CPU
+} SubsConfig;
+
+const char *cs642SubsStrategyStrings[] = {"hillclimb", "anneal", "tabu"};
+const char *cs642ScoreModeStrings[] = {"float", "fixed"};
+static SubsConfig subsConfig = {SUBS_HILLCLIMB, SUBS_ITERS, SUBS_SUBITERS, 0, 0};
+static atomic_uint subsSearches = 0; // SUBS analyses started, mixed into seeds
+static uint64_t subsSeed = 0;        // seed of the first SUBS analysis, 0 for
+                                     // a seed from the clock
+
+// shared state of a parallel SUBS search, the best slot is lock-free: each
+// chain publishes its own best score and bestChain is moved by CAS
+typedef struct subssearch {
+  const cs642Text *text;      // normalized ciphertext shared by all chains
+  const uint8_t *letters;
+  int clen;
+  char *freqKey;
+  int seeded;                 // freqKey was completed from word patterns
+  const cs642Model *model;    // reference held for the whole search
+  SubsConfig config;
+  struct timespec deadline;   // only used when config.timeMs > 0
+  atomic_int nextRound;       // next restart to hand out
+  atomic_int solved;          // set once a chain's key passes checkBestKey
+  atomic_int confirmed;       // set once restarts keep converging on one key
+  atomic_int expired;         // set once the time budget runs out
+  int maxRounds;              // restarts allowed
+  pthread_mutex_t confirmLock;
+  char confirmKey[NALPHA + 1]; // best round key so far, and how many rounds
+  double confirmScore;        // converged on it
+  int confirmRounds;
+  atomic_int bestChain;       // chain holding the best key, -1 if none yet
+  struct subschain *chains;
+} SubsSearch;
+
+// one independent hill-climbing chain with its own PRNG and scratch buffers
+typedef struct subschain {
+  SubsSearch *search;
+  int id;
+  cs642Random rng;
+  SubsScorer scorer;
+  Scratch scratch;
+  char key[NALPHA + 1];
+  char bestKey[NALPHA + 1];
+  _Atomic double bestScore;
+  int solved;
+} SubsChain;
+
+// letter histograms of the columns of every candidate Vigenere key size,
+// packed as counts[(offsets[keysize - minKeysize] + column) * NALPHA + letter]
+typedef struct columnhists {
+  int minKeysize;
+  int maxKeysize;
+  int *offsets;               // first column of each key size
+  uint32_t *counts;
+} ColumnHists;
+
+// runtime configuration of the Vigenere key length search
+typedef struct vigeconfig {
+  int minKeysize;
+  int maxKeysize;             // inclusive
+  int topk;                   // key lengths fully solved
+} VigeConfig;
+
+static VigeConfig vigeConfig = {MIN_KEYSIZE, MAX_KEYSIZE - 1, VIGE_TOPK};
+
+// the key search of a cipher, run on the ciphertexts the cache cannot answer
+typedef int (*KeySearch)(const cs642Text *text, char *plaintext, int plen,
+                         char *key);
+
+// the result cache size, and the file it is kept in if any
+static int cacheEntries = CS642_CACHE_ENTRIES;
+static const char *cachePath = NULL;
+
+// the language model shared by the process, mapped from its file or built
+// from the dict, and the tables derived from it at init
+static const char *modelPath = CS642_MODEL_FILE;
+static const cs642Model *langModel = NULL;
+
+// letter probabilities of the dictionary words, and the letters from the
+// most to the least frequent
+static double dictLetterProbs[NALPHA];
+static char dictLetterOrder[NALPHA];
+
+// dense 4-gram log-probability table over the letters and the word space,
+// indexed by a*27^3 + b*27^2 + c*27 + d
+static const float *ngramLogProbs = NULL;
+static float ngramFloor = 0;
+static int ngramWords = 0;    // the model scores 4-grams across words
+
+// the same table quantized to int16 when scoring in fixed point, else NULL
+static cs642ScoreMode scoreMode = CS642_SCORE_FLOAT;
+static const int16_t *ngramFixed = NULL;
+static double ngramFixedUnit = 1;
+
+// search iterations of the last analysis run on each thread
+static _Thread_local long analysisIterations = 0;
 
 // swap two indices
 void swap(int a, int b, char *array) {
@@ -59,225 +236,630 @@ int comparator(const void *a, const void *b) {
     return (B->freq - A->freq);
 }
 
-// display cipher matrix
-void printMatrix(char **matrix, int rows, int cols) {
-  for (int i = 0; i < rows; i++) {
-    for (int j = 0; j < cols; j++) {
-      printf("%c", matrix[i][j]);
+// FNV-1a hash of the first n chars of a word
+uint32_t hashWord(const char *word, int n) {
+  uint32_t h = 2166136261u;
+  for (int i = 0; i < n; i++) {
+    h ^= (uint8_t)word[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// build the dictionary hash index, summing counts of duplicate words
+int buildDictIndex(void) {
+  int i, n;
+  uint32_t h, slot, size = 1;
+  int dictSize = cs642GetDictSize();
+
+  while (size < (uint32_t)dictSize * DICT_LOAD_FACTOR) size <<= 1;
+  dictIndex = calloc(size, sizeof(DictEntry));
+  if (dictIndex == NULL) return -1;
+  dictIndexMask = size - 1;
+
+  for (i = 0; i < dictSize; i++) {
+    struct DictWord dictWord = cs642GetWordfromDict(i);
+    n = strlen(dictWord.word);
+    h = hashWord(dictWord.word, n);
+    // linear probing until a free slot or the same word is found
+    for (slot = h & dictIndexMask; dictIndex[slot].word; slot = (slot + 1) & dictIndexMask) {
+      if (dictIndex[slot].hash == h && dictIndex[slot].len == n &&
+          strncmp(dictIndex[slot].word, dictWord.word, n) == 0)
+        break;
+    }
+    if (dictIndex[slot].word == NULL) {
+      dictIndex[slot].word = dictWord.word;
+      dictIndex[slot].len = n;
+      dictIndex[slot].hash = h;
     }
-    printf("\n");
+    dictIndex[slot].count += dictWord.count;
   }
+  return 0;
 }
 
-// shift a char left by x
-char rotByX(char chr, int x) {
-  int rotChr = (int)chr - x;
-  return rotChr < (int)'A' ? (int)'Z' - ((int)'A' - rotChr) + 1: (char)rotChr;
+// get the corpus count of a word (first n chars), 0 if not in the dict
+int dictLookup(const char *word, int n) {
+  uint32_t slot, h = hashWord(word, n);
+
+  for (slot = h & dictIndexMask; dictIndex[slot].word; slot = (slot + 1) & dictIndexMask) {
+    if (dictIndex[slot].hash == h && dictIndex[slot].len == n &&
+        strncmp(dictIndex[slot].word, word, n) == 0)
+      return dictIndex[slot].count;
+  }
+  return 0;
 }
 
 // get num of occurrences of a word in the given dict
 void checkDictionary(char *inputWord, int *dictMatches) {
-  int j;
-  int dictSize = cs642GetDictSize();
+  if (dictLookup(inputWord, strlen(inputWord)) > 0)
+    *dictMatches = *dictMatches + 1;
+}
 
-  for (j = 0; j < dictSize; j++) {
-    struct DictWord dictWord = cs642GetWordfromDict(j);
-    if (strcmp(inputWord, dictWord.word) == 0) {
-      *dictMatches = *dictMatches + 1;
+// count the dictionary words of a decryption, found at the word offsets of
+// its normalized ciphertext; stopOnMiss > 0 gives up with -1 at that many
+// misses
+int countDictWords(const cs642Text *text, const char *plain, int stopOnMiss) {
+  int words = 0, matches = 0, misses = 0;
+  const cs642Word *word;
+  uint64_t start = cs642StatNow();
+
+  while (words < text->nwords) {
+    word = &text->words[words++];
+    if (dictLookup(&plain[word->start], word->len) > 0) matches++;
+    else if (stopOnMiss && ++misses == stopOnMiss) {
+      matches = -1;
+      break;
     }
   }
+  cs642StatCount(CS642_COUNT_DICT_WORDS, words);
+  cs642StatTime(CS642_PHASE_DICT, start);
+  return matches;
+}
+
+// check if a decryption is certainly right: most of a sample of its first
+// words are in the dict, while a wrong key only leaves a few short words
+int confidentDecryption(const cs642Text *text, const char *plain) {
+  int words = 0, matches = 0;
+  const cs642Word *word;
+  uint64_t start = cs642StatNow();
+
+  while (words < text->nwords && words < CONFIDENT_SAMPLE_WORDS) {
+    word = &text->words[words++];
+    if (dictLookup(&plain[word->start], word->len) > 0) matches++;
+  }
+  cs642StatCount(CS642_COUNT_DICT_WORDS, words);
+  cs642StatTime(CS642_PHASE_DICT, start);
+  return words >= CONFIDENT_MIN_WORDS && matches >= CONFIDENT_SHARE * words;
 }
 
-// get letter frequencies in a given ciphertext
-void getLetterFreqs(char *ciphertext, int clen, int *counts) {
-  int i, idx;
-  char chr;
+// allocate the scratch buffers for analyzing a ciphertext of length clen
+int initScratch(Scratch *scratch, int clen) {
+  scratch->size = clen + 1;
+  scratch->text = malloc(scratch->size);
+  if (scratch->text == NULL) return -1;
+  scratch->text[clen] = '\0';
+  return 0;
+}
+
+// release the scratch buffers of an analysis
+void freeScratch(Scratch *scratch) {
+  free(scratch->text);
+  scratch->text = NULL;
+  scratch->size = 0;
+}
+
+// get the letter frequencies of a normalized ciphertext
+void getLetterFreqs(const uint8_t *letters, int clen, int *counts) {
+  int i;
+  uint32_t hist[NALPHA];
+
+  uint64_t start = cs642StatNow();
+
+  letterHistogram(letters, clen, 0, hist);
+  cs642StatTime(CS642_PHASE_HISTOGRAM, start);
+  for (i = 0; i < NALPHA; i++) {
+    counts[i] += hist[i];
+  }
+}
 
-  for (i = 0; i < clen; i++) {
-    chr = ciphertext[i];
-    if (isupper(chr)) {
-      idx = (int)chr - (int)'A';
-      counts[idx]++;
+// accumulate the letter histogram of every column of every key size in
+// [minKeysize, maxKeysize] in one pass over the normalized ciphertext, the
+// column of position i being i % keysize (spaces count as positions)
+int buildColumnHists(ColumnHists *hists, const uint8_t *letters, int len,
+                     int minKeysize, int maxKeysize) {
+  int i, k, nk = maxKeysize - minKeysize + 1, total = 0;
+  int col[nk];
+  uint8_t c;
+  uint64_t start = cs642StatNow();
+
+  hists->minKeysize = minKeysize;
+  hists->maxKeysize = maxKeysize;
+  hists->offsets = malloc(nk * sizeof(int));
+  if (hists->offsets == NULL) return -1;
+  for (k = 0; k < nk; k++) {
+    hists->offsets[k] = total;
+    total += minKeysize + k;
+    col[k] = 0;
+  }
+  hists->counts = calloc((size_t)total * NALPHA, sizeof(uint32_t));
+  if (hists->counts == NULL) return -1;
+
+  for (i = 0; i < len; i++) {
+    c = letters[i];
+    if (c < NALPHA) {
+      for (k = 0; k < nk; k++) {
+        hists->counts[(hists->offsets[k] + col[k]) * NALPHA + c]++;
+      }
+    }
+    // advance every key size's column, wrapping without a division
+    for (k = 0; k < nk; k++) {
+      if (++col[k] == minKeysize + k) col[k] = 0;
     }
   }
+  cs642StatTime(CS642_PHASE_HISTOGRAM, start);
+  return 0;
 }
 
-// get letter frequencies in the given dict
-int getDictLetterFreqs(int *counts) {
-  int i, n;
-  int dictSize = cs642GetDictSize();
-  int total = 0;
+// get the histogram of one column for a key size
+uint32_t *columnHist(ColumnHists *hists, int keysize, int col) {
+  return &hists->counts[(hists->offsets[keysize - hists->minKeysize] + col) * NALPHA];
+}
 
-  for (i = 0; i < dictSize; i++) {
-    struct DictWord dictword = cs642GetWordfromDict(i);
-    n = strlen(dictword.word);
-    getLetterFreqs(dictword.word, n, counts);
+// release the column histograms
+void freeColumnHists(ColumnHists *hists) {
+  free(hists->counts);
+  free(hists->offsets);
+  hists->counts = NULL;
+  hists->offsets = NULL;
+}
+
+// compute the Friedman's Test summed over the columns of a key size
+double friedmanTotal(ColumnHists *hists, int keysize) {
+  int i, j;
+  uint32_t *freqs;
+  double N, freqSum, Ko, friedmanTotal = 0;
+
+  for (i = 0; i < keysize; i++) {
+    // take each column as a separate rotx cipher
+    freqs = columnHist(hists, keysize, i);
+    N = freqSum = 0;
+    for (j = 0; j < NALPHA; j++) {
+      N += freqs[j];
+      freqSum += (double)freqs[j] * (freqs[j] - 1.0);
+    }
+    // do Friedman's Test
+    Ko = N > 1 ? freqSum / (N * (N - 1)) : 0;
+    friedmanTotal += Ko;
   }
+  return friedmanTotal;
+}
 
-  for (i = 0; i < NALPHA; i++) {
-    total += counts[i];
+// count, for every key size, how many distances between repeated trigrams it
+// divides (Kasiski examination), returns the number of repeats seen
+int kasiskiCounts(const uint8_t *letters, int len, int minKeysize,
+                  int maxKeysize, int *counts) {
+  int i, k, d, tri, repeats = 0;
+  int *lastPos = malloc(NTRIGRAMS * sizeof(int));
+
+  if (lastPos == NULL) return 0;
+  memset(lastPos, -1, NTRIGRAMS * sizeof(int));
+  memset(counts, 0, (maxKeysize - minKeysize + 1) * sizeof(int));
+  for (i = 0; i + 2 < len; i++) {
+    if (letters[i] >= NALPHA || letters[i + 1] >= NALPHA || letters[i + 2] >= NALPHA)
+      continue;
+    tri = (letters[i] * NALPHA + letters[i + 1]) * NALPHA + letters[i + 2];
+    if (lastPos[tri] >= 0) {
+      d = i - lastPos[tri];
+      for (k = minKeysize; k <= maxKeysize; k++) {
+        if (d % k == 0) counts[k - minKeysize]++;
+      }
+      repeats++;
+    }
+    lastPos[tri] = i;
   }
-  return total;
+  free(lastPos);
+  return repeats;
 }
 
-// create transposed ciphermatrix for vigenere, where rows = keysize
-void createCipherMatrix(char *ciphertext, int clen, int rows, int cols, char **matrix, int spaces) {
-  int i, j, c_i = 0;
-  char chr;
+// rank the key sizes of the column histograms by their normalized average
+// column IC plus the excess of repeated trigram distances they divide over
+// chance, putting the best topk in ranked and returning how many there are
+int rankVIGEKeysizes(ColumnHists *hists, const uint8_t *letters, int len,
+                     int *ranked, int topk) {
+  int i, j, k, repeats, nk = hists->maxKeysize - hists->minKeysize + 1;
+  int kasiski[nk];
+  double ic, excess, score[nk];
+
+  repeats = kasiskiCounts(letters, len, hists->minKeysize, hists->maxKeysize, kasiski);
+  for (i = 0; i < nk; i++) {
+    k = hists->minKeysize + i;
+    ic = friedmanTotal(hists, k) / k;
+    score[i] = (ic - Kr) / (Kp - Kr);
+    // multiples of the key length share its IC, but divide only part of the
+    // distances, while its divisors have a random-text IC
+    if (repeats > 0 && k > 1) {
+      excess = ((double)kasiski[i] / repeats - 1.0 / k) / (1.0 - 1.0 / k);
+      score[i] += excess;
+    }
+  }
+
+  // keep the topk best scores, ties going to the shorter key
+  if (topk > nk) topk = nk;
+  for (i = 0; i < nk; i++) {
+    for (j = i < topk ? i : topk; j > 0 && score[ranked[j - 1] - hists->minKeysize] < score[i]; j--) {
+      if (j < topk) ranked[j] = ranked[j - 1];
+    }
+    if (j < topk) ranked[j] = hists->minKeysize + i;
+  }
+  return topk;
+}
 
-  for (j = 0; j < cols; j++) {
-    for (i = 0; i < rows; i++) {
-      if (j == 0) matrix[i] = malloc(cols * sizeof(char));
-      // to include/ not-include spaces in the matrix
-      while (!spaces && c_i < clen && ((chr = ciphertext[c_i]) == ' ')) { c_i++; }
-      if (c_i >= clen) { matrix[i][j] = '\0'; return; }
-      matrix[i][j] = ciphertext[c_i++];
+// get the best average column IC over the key sizes of the Vigenere search,
+// a polyalphabetic text peaks at its key length while the others stay flat
+double bestPeriodicIC(const uint8_t *letters, int clen, VigeConfig *config) {
+  int k;
+  double ic, best = 0;
+  ColumnHists hists = {0};
+
+  if (buildColumnHists(&hists, letters, clen, config->minKeysize, config->maxKeysize) == 0) {
+    for (k = config->minKeysize; k <= config->maxKeysize; k++) {
+      ic = friedmanTotal(&hists, k) / k;
+      if (ic > best) best = ic;
     }
   }
+  freeColumnHists(&hists);
+  return best;
 }
 
-// compute the Friedman's Test on a given cipher matrix
-double friedmanTotal(char **cipherMatrix, int clen, int rows, int cols) {
-  int i, j, N;
-  double freqSum;
-  double Ko, friedmanTotal = 0;
+// pick every key letter of a key size by the minimum Chi Squared shift of its column
+void solveVIGEColumns(ColumnHists *hists, int keysize, char *key) {
+  int i, k;
+  double chiScores[NALPHA], minChiScore;
 
-  for (i = 0; i < rows; i++) {
-    // take each row value as a separate rotx cipher
-    N = 0;
-    char subcipher[cols];
-    for (j = 0; j < cols && cipherMatrix[i][j]; j++) {
-      char chr = cipherMatrix[i][j];
-      if (isupper(chr) || chr == ' ') {
-        if (isupper(chr)) N++;
-        subcipher[j] = chr;
+  for (i = 0; i < keysize; i++) {
+    // each column is a rotx cipher, get the Chi Squared value of every shift
+    // by rotating its histogram
+    chiSquaredShifts(columnHist(hists, keysize, i), dictLetterProbs, chiScores);
+    minChiScore = INFINITY;
+    for (k = 0; k < NALPHA; k++) {
+      // reconstruct key from the best shift
+      if (chiScores[k] < minChiScore) {
+        minChiScore = chiScores[k];
+        key[i] = (char)((int)'A' + k);
       }
     }
+  }
+  key[keysize] = '\0';
+}
 
-    // get letter frequencies in row
-    int freqs[NALPHA] = {0};
-    getLetterFreqs(subcipher, strlen(subcipher), freqs);
+// get the 4-gram fitness of the decryption of the first len letters
+static double vigeFitness(const uint8_t *letters, int len, const char *key,
+                          int keysize, char *text) {
+  int n;
 
-    // do Friedman's Test
-    freqSum = 0;
-    for (j = 0; j < NALPHA; j++) {
-      if (freqs[j] > 0)
-        freqSum += (freqs[j] * (freqs[j] - 1));
+  decryptVIGELetters(letters, len, key, keysize, text);
+  text[len] = '\0';
+  return cipherNGPSum(text, &n);
+}
+
+// refine a Vigenere key whose columns were solved one at a time: each column
+// offers its best chi squared shifts and the shift its mutual IC with the
+// most certain column implies, and coordinate descent keeps the letter that
+// gives the decryption of a sample of the text the best 4-gram fitness
+void refineVIGEKey(ColumnHists *hists, const uint8_t *letters, int clen,
+                   int keysize, char *key, char *text) {
+  char cands[VIGE_KEYSIZE_LIMIT][VIGE_REFINE_CANDIDATES + 1];
+  int order[NALPHA];
+  double chi[NALPHA], margin, bestMargin = -1, mic, bestMic, score, best;
+  int i, j, k, c, s, pass, improved, anchor = 0;
+  int len = clen < VIGE_REFINE_SAMPLE ? clen : VIGE_REFINE_SAMPLE;
+  uint32_t *fa, *fb;
+  char prev;
+
+  // rank the shifts of each column by chi squared, the column whose best
+  // shift beats its second by the most anchors the alignment
+  for (i = 0; i < keysize; i++) {
+    chiSquaredShifts(columnHist(hists, keysize, i), dictLetterProbs, chi);
+    for (k = 0; k < NALPHA; k++) {
+      for (j = k; j > 0 && chi[order[j - 1]] > chi[k]; j--) order[j] = order[j - 1];
+      order[j] = k;
+    }
+    for (c = 0; c < VIGE_REFINE_CANDIDATES; c++) cands[i][c] = 'A' + order[c];
+    margin = chi[order[1]] - chi[order[0]];
+    if (margin > bestMargin) {
+      bestMargin = margin;
+      anchor = i;
+    }
+  }
+
+  // the shift between two columns is the difference of their key letters,
+  // and lines their histograms up best (the highest mutual IC)
+  fa = columnHist(hists, keysize, anchor);
+  for (i = 0; i < keysize; i++) {
+    fb = columnHist(hists, keysize, i);
+    bestMic = -1;
+    for (s = 0; s < NALPHA; s++) {
+      for (k = 0, mic = 0; k < NALPHA; k++) mic += (double)fa[k] * fb[(k + s) % NALPHA];
+      if (mic > bestMic) {
+        bestMic = mic;
+        cands[i][VIGE_REFINE_CANDIDATES] = 'A' + (key[anchor] - 'A' + s) % NALPHA;
+      }
+    }
+  }
+
+  // coordinate descent on the fitness of the sample decryption
+  best = vigeFitness(letters, len, key, keysize, text);
+  for (pass = 0, improved = 1; pass < VIGE_REFINE_PASSES && improved; pass++) {
+    improved = 0;
+    for (i = 0; i < keysize; i++) {
+      for (c = 0; c <= VIGE_REFINE_CANDIDATES; c++) {
+        if (cands[i][c] == key[i]) continue;
+        prev = key[i];
+        key[i] = cands[i][c];
+        score = vigeFitness(letters, len, key, keysize, text);
+        if (score > best) {
+          best = score;
+          improved = 1;
+        } else {
+          key[i] = prev;
+        }
+      }
     }
-    Ko = freqSum / (N * (N - 1));
-    friedmanTotal += Ko;
   }
-  return friedmanTotal;
 }
 
-// compute the Chi-Squared Test for a given ciphertext
-double chiSquared(char *cipher, int cn, int *E, int en) {
+// load the language model, mapping its file if there is a valid one and
+// otherwise counting the dict, then derive the letter statistics from it
+int loadLangModel(void) {
   int i;
-  double Ci, Ei, total = 0;
-  int C[NALPHA] = {0};
-  getLetterFreqs(cipher, strlen(cipher), C);
+  double total = 0;
+  LF letters[NALPHA];
+
+  if ((langModel = cs642ShareModel(modelPath)) == NULL) return -1;
+  ngramLogProbs = langModel->logProbs[NGRAMSIZE - 1];
+  ngramFloor = langModel->floors[NGRAMSIZE - 1];
+  ngramWords = (langModel->flags & CS642_MODEL_WORD_GRAMS) != 0;
+  if (scoreMode == CS642_SCORE_FIXED) {
+    ngramFixed = langModel->fixedLogProbs;
+    ngramFixedUnit = langModel->fixedUnit;
+  }
 
   for (i = 0; i < NALPHA; i++) {
-    Ci = (double)C[i] / cn;
-    Ei = ((double)E[i] / en) * cn;
-    total += (pow(Ci - Ei, 2) / Ei);
+    dictLetterProbs[i] = exp(langModel->logProbs[0][i]);
+    total += dictLetterProbs[i];
+  }
+  for (i = 0; i < NALPHA; i++) {
+    dictLetterProbs[i] /= total;
+    LF lfMap = { (char)((int)'A' + i), (int)(dictLetterProbs[i] * 1e8) };
+    letters[i] = lfMap;
   }
-  return total;
+  qsort(letters, NALPHA, sizeof(LF), comparator);
+  for (i = 0; i < NALPHA; i++) {
+    dictLetterOrder[i] = letters[i].letter;
+  }
+  return 0;
 }
 
-// get all 4-grams in the given dicionary for substition cipher
-int getDictNGrams(char ngrams[][NGRAMSIZE]) {
-  int i, j, k, n, cnt = 0;
-  char ngram[NGRAMSIZE];
-  int dictSize = cs642GetDictSize();
+// get the model symbol of a text character, letters of either case, any
+// non-letter separates words
+static inline int textSymbol(char ch) {
+  unsigned int c = ((unsigned char)ch | 0x20) - 'a';
+  return c < NALPHA ? (int)c : WORD_SPACE;
+}
 
-  for (i = 0; i < dictSize; i++) {
-    struct DictWord dictword = cs642GetWordfromDict(i);
-    n = strlen(dictword.word);
-    for (j = 0; j < n - NGRAMSIZE + 1; j++) {
-      for (k = 0; k < NGRAMSIZE; k++) {
-        ngram[k] = dictword.word[j + k];
-      }
-      strcpy(ngrams[cnt++], ngram);
+// get log prob sum of the 4-grams of a text and their number; the text is
+// read as the model was counted, with the separators around and between words
+// for a model counted across words and inside each word otherwise
+double cipherNGPSum(char *ciphertext, int *ngrams) {
+  int i, sym, len = 0, last = -1, n = 0;
+  size_t idx = 0;
+  double ngpsum = 0;
+  int64_t fixedSum = 0;
+
+  if (ngramWords) {
+    idx = last = WORD_SPACE;
+    len = 1;
+  }
+  for (i = 0; ; i++) {
+    sym = ciphertext[i] ? textSymbol(ciphertext[i]) : WORD_SPACE;
+    if (sym == WORD_SPACE && (!ngramWords || last == WORD_SPACE)) {
+      if (!ngramWords) len = 0;
+      if (!ciphertext[i]) break;
+      continue;
+    }
+    last = sym;
+    idx = (idx * NSYMBOLS + sym) % NQUADGRAMS;
+    if (++len >= NGRAMSIZE) {
+      if (ngramFixed) fixedSum += ngramFixed[idx];
+      else ngpsum += ngramLogProbs[idx];
+      n++;
     }
+    if (!ciphertext[i]) break;
   }
-  return cnt;
+  *ngrams = n;
+  return ngramFixed ? fixedSum * ngramFixedUnit : ngpsum;
 }
 
-// get all 4-gram probabilities in a dict 4-gram list
-double getDictNGramProb(char *ngram, char dictNGrams[][NGRAMSIZE], double dictNGramProbs[], int dngcnt) {
-  int i = 0;
-  for (i = 0; i < dngcnt; i++) {
-    if (strncmp(ngram, dictNGrams[i], NGRAMSIZE) == 0) {
-      return dictNGramProbs[i];
+// get the log prob of the 4-gram at offset off in the scorer text
+static inline double gramScore(SubsScorer *scorer, int off) {
+  uint8_t *t = &scorer->text[off], *p = scorer->plain;
+  return scorer->logProbs[((p[t[0]] * NSYMBOLS + p[t[1]]) * NSYMBOLS + p[t[2]]) * NSYMBOLS + p[t[3]]];
+}
+
+// get the fixed-point log prob of the 4-gram at offset off in the scorer text
+static inline int gramFixed(SubsScorer *scorer, int off) {
+  uint8_t *t = &scorer->text[off], *p = scorer->plain;
+  return scorer->fixedProbs[((p[t[0]] * NSYMBOLS + p[t[1]]) * NSYMBOLS + p[t[2]]) * NSYMBOLS + p[t[3]]];
+}
+
+// index the scored 4-grams of a ciphertext by the cipher letters they contain
+int initSubsScorer(SubsScorer *scorer, const cs642Model *model, const uint8_t *letters,
+                   int clen) {
+  int i, j, c, sym, n = 0, wordLen = 0;
+  int words = (model->flags & CS642_MODEL_WORD_GRAMS) != 0;
+  int fill[NALPHA];
+
+  memset(scorer, 0, sizeof(SubsScorer));
+  scorer->text = malloc(clen + 2);
+  scorer->grams = malloc((clen + 2) * sizeof(int));
+  scorer->occ = malloc((NGRAMSIZE * (clen + 2) + 1) * sizeof(int));
+  if (!scorer->text || !scorer->grams || !scorer->occ) return -1;
+  scorer->plain[WORD_SPACE] = WORD_SPACE;
+  scorer->logProbs = model->logProbs[NGRAMSIZE - 1];
+  if (scoreMode == CS642_SCORE_FIXED) {
+    scorer->fixedProbs = model->fixedLogProbs;
+    scorer->fixedUnit = model->fixedUnit;
+  }
+
+  // compact the letters, and the word separators the model scores, recording
+  // where each full 4-gram ends, the same 4-grams as cipherNGPSum
+  if (words) {
+    scorer->text[n++] = WORD_SPACE;
+    wordLen = 1;
+  }
+  for (i = 0; i <= clen; i++) {
+    // the normalized separator LETTER_SPACE is the model's WORD_SPACE
+    sym = i < clen ? letters[i] : WORD_SPACE;
+    if (sym == WORD_SPACE && (!words || scorer->text[n - 1] == WORD_SPACE)) {
+      if (!words) wordLen = 0;
+      continue;
     }
+    scorer->text[n++] = sym;
+    if (++wordLen >= NGRAMSIZE) scorer->grams[scorer->ngrams++] = n - NGRAMSIZE;
   }
-  // very-low probability if ngram doesn't exist in dictionary
-  return log(1.0 / dngcnt);
-}
 
-// get log probability of a 4-gram
-double getNGramProb(char *ngram, char ngrams[][NGRAMSIZE], int n) {
-  int i, cnt = 0;
-  for (i = 0; i < n; i++) {
-    if (strncmp(ngram, ngrams[i], NGRAMSIZE) == 0) {
-      cnt++;
+  // count each 4-gram once per distinct cipher letter it contains
+  for (i = 0; i < scorer->ngrams; i++) {
+    uint8_t *t = &scorer->text[scorer->grams[i]];
+    for (j = 0; j < NGRAMSIZE; j++) {
+      if (t[j] != WORD_SPACE && memchr(t, t[j], j) == NULL) scorer->occStart[t[j] + 1]++;
     }
   }
-  return log((double)cnt / n);
+  for (c = 0; c < NALPHA; c++) {
+    scorer->occStart[c + 1] += scorer->occStart[c];
+    fill[c] = scorer->occStart[c];
+  }
+  for (i = 0; i < scorer->ngrams; i++) {
+    uint8_t *t = &scorer->text[scorer->grams[i]];
+    for (j = 0; j < NGRAMSIZE; j++) {
+      if (t[j] != WORD_SPACE && memchr(t, t[j], j) == NULL)
+        scorer->occ[fill[t[j]]++] = scorer->grams[i];
+    }
+  }
+  return 0;
 }
 
-// get log prob sum of all 4-grams in a given ciphertext, compared to 4-grams in a dict
-double cipherNGPSum(char *ciphertext, char dictNGrams[][NGRAMSIZE], double dictNGramProbs[], int dngcnt) {
-  int i, j, n;
-  char *cipherdup;
-  char ngram[NGRAMSIZE];
-  double ngpsum = 0;
+// release the buffers of a scorer
+void freeSubsScorer(SubsScorer *scorer) {
+  free(scorer->text);
+  free(scorer->grams);
+  free(scorer->occ);
+  memset(scorer, 0, sizeof(SubsScorer));
+}
 
-  cipherdup = strdup(ciphertext);
-  char *delim = " ";
-  char *word = strtok(cipherdup, delim);
-  while (word != NULL) {
-    n = strlen(word);
-    // break word into n-grams
-    for (i = 0; i < n - NGRAMSIZE + 1; i++) {
-      for (j = 0; j < NGRAMSIZE; j++) {
-        ngram[j] = word[i + j];
-      }
-      // sum together log probs of all n-grams in the text
-      ngpsum += getDictNGramProb(ngram, dictNGrams, dictNGramProbs, dngcnt);
+// load a key into the scorer and fully score the text under it
+double setSubsScorerKey(SubsScorer *scorer, char *key) {
+  int i;
+
+  for (i = 0; i < NALPHA; i++) {
+    scorer->plain[key[i] - 'A'] = i;
+  }
+  scorer->score = 0;
+  if (scorer->fixedProbs) {
+    int64_t sum = 0;
+    for (i = 0; i < scorer->ngrams; i++) {
+      sum += gramFixed(scorer, scorer->grams[i]);
+    }
+    scorer->score = sum * scorer->fixedUnit;
+  } else {
+    for (i = 0; i < scorer->ngrams; i++) {
+      scorer->score += gramScore(scorer, scorer->grams[i]);
     }
-    word = strtok(NULL, delim);
   }
-  return ngpsum;
+  scorer->prevScore = scorer->score;
+  return scorer->score;
+}
+
+// sum the fixed-point log probs of the 4-grams touching cipher letters a or
+// b in an integer, the steps being a power of two the double result is exact
+static double pairScoreFixed(SubsScorer *scorer, int a, int b) {
+  int i, off;
+  int64_t sum = 0;
+
+  for (i = scorer->occStart[a]; i < scorer->occStart[a + 1]; i++) {
+    sum += gramFixed(scorer, scorer->occ[i]);
+  }
+  for (i = scorer->occStart[b]; i < scorer->occStart[b + 1]; i++) {
+    off = scorer->occ[i];
+    if (memchr(&scorer->text[off], a, NGRAMSIZE) == NULL)
+      sum += gramFixed(scorer, off);
+  }
+  return sum * scorer->fixedUnit;
+}
+
+// sum the log probs of the 4-grams touching cipher letters a or b
+static double pairScore(SubsScorer *scorer, int a, int b) {
+  int i, off;
+  double sum = 0;
+
+  if (scorer->fixedProbs) return pairScoreFixed(scorer, a, b);
+
+  for (i = scorer->occStart[a]; i < scorer->occStart[a + 1]; i++) {
+    sum += gramScore(scorer, scorer->occ[i]);
+  }
+  for (i = scorer->occStart[b]; i < scorer->occStart[b + 1]; i++) {
+    // 4-grams containing both letters were already counted with a
+    off = scorer->occ[i];
+    if (memchr(&scorer->text[off], a, NGRAMSIZE) == NULL)
+      sum += gramScore(scorer, off);
+  }
+  return sum;
+}
+
+// swap two key positions and update the score from the affected 4-grams only
+double swapSubsScorerKey(SubsScorer *scorer, char *key, int i1, int i2) {
+  int a = key[i1] - 'A', b = key[i2] - 'A';
+  double before = pairScore(scorer, a, b);
+
+  swap(i1, i2, key);
+  scorer->plain[a] = i2;
+  scorer->plain[b] = i1;
+  scorer->prevScore = scorer->score;
+  scorer->score += pairScore(scorer, a, b) - before;
+  scorer->evals++;
+  cs642StatCount(CS642_COUNT_SWAPS, 1);
+  return scorer->score;
 }
 
-void getInitFreqDerivedKey(char *ciphertext, int clen, char key[NALPHA + 1]) {
+// revert the last swap without rescoring
+void undoSubsScorerSwap(SubsScorer *scorer, char *key, int i1, int i2) {
+  swap(i1, i2, key);
+  scorer->plain[key[i1] - 'A'] = i1;
+  scorer->plain[key[i2] - 'A'] = i2;
+  scorer->score = scorer->prevScore;
+  cs642StatCount(CS642_COUNT_REJECTED, 1);
+}
+
+void getInitFreqDerivedKey(const cs642Text *text, char key[NALPHA + 1]) {
   int i, j;
-  LF dictFreqMap[NALPHA], cipherFreqMap[NALPHA];
+  LF cipherFreqMap[NALPHA];
 
-  // map dict letters to freqs
-  int dictFreqs[NALPHA] = {0};
+  // map cipher letters to freqs, the dict letters are ranked once at init
   int cipherFreqs[NALPHA] = {0};
-  getDictLetterFreqs(dictFreqs);
-  getLetterFreqs(ciphertext, clen, cipherFreqs);
+  getLetterFreqs(text->letters, text->len, cipherFreqs);
   for (i = 0; i < NALPHA; i++) {
-      LF lfMap1 = { (char)((int)'A' + i), dictFreqs[i] };
-      dictFreqMap[i] = lfMap1;
-
-      LF lfMap2 = { (char)((int)'A' + i), cipherFreqs[i] };
-      cipherFreqMap[i] = lfMap2;
+      LF lfMap = { (char)((int)'A' + i), cipherFreqs[i] };
+      cipherFreqMap[i] = lfMap;
   }
 
-  // sort both in descending order of freq
-  qsort(dictFreqMap, NALPHA, sizeof(LF), comparator);
+  // sort in descending order of freq
   qsort(cipherFreqMap, NALPHA, sizeof(LF), comparator);
 
   // construct initial freq derived key
   for (i = 0; i < NALPHA; i++) {
     char curr = key[i];
     for (j = 0; j < NALPHA; j++) {
-      if (dictFreqMap[j].letter == curr) {
+      if (dictLetterOrder[j] == curr) {
         key[i] = cipherFreqMap[j].letter;
         break;
       }
@@ -286,8 +868,38 @@ void getInitFreqDerivedKey(char *ciphertext, int clen, char key[NALPHA + 1]) {
   key[NALPHA] = '\0';
 }
 
+// seed a frequency derived key with the letters the word-pattern solver maps:
+// the solved plain letters take their cipher letters and the rest keep the
+// frequency ranking over the cipher letters left, returns the letters solved
+static int getPatternSeededKey(const cs642Text *text, char key[NALPHA + 1]) {
+  int8_t plainOf[NALPHA];
+  char cipherByRank[NALPHA], seeded[NALPHA];
+  int i, j, p, mapped;
+
+  mapped = cs642SolvePatterns(text, plainOf);
+  if (mapped < SUBS_SEED_MIN_LETTERS) return mapped;
+
+  // the frequency key gives plain letter dictLetterOrder[j] the cipher letter
+  // of frequency rank j
+  for (j = 0; j < NALPHA; j++) {
+    cipherByRank[j] = key[dictLetterOrder[j] - 'A'];
+  }
+  memset(seeded, 0, sizeof(seeded));
+  for (i = 0; i < NALPHA; i++) {
+    if (plainOf[i] >= 0) seeded[(int)plainOf[i]] = 'A' + i;
+  }
+  for (i = 0, j = 0; i < NALPHA; i++) {
+    p = dictLetterOrder[i] - 'A';
+    if (seeded[p]) continue;
+    while (plainOf[cipherByRank[j] - 'A'] >= 0) j++;
+    seeded[p] = cipherByRank[j++];
+  }
+  memcpy(key, seeded, NALPHA);
+  return mapped;
+}
+
 // generate a random substition cipher key (Fisher-Yates shuffling)
-void generateRandomKey(char key[NALPHA + 1]) {
+void generateRandomKey(char key[NALPHA + 1], cs642Random *rng) {
   int i, j;
   char tmp;
 
@@ -296,7 +908,7 @@ void generateRandomKey(char key[NALPHA + 1]) {
   }
 
   for (i = NALPHA - 1; i > 0; i--) {
-    j = rand() % (i + 1);
+    j = cs642RandomBelow(rng, i + 1);
     tmp = key[i];
     key[i] = key[j];
     key[j] = tmp;
@@ -304,22 +916,370 @@ void generateRandomKey(char key[NALPHA + 1]) {
   key[NALPHA] = '\0';
 }
 
-int checkBestKey(char *plaintext) {
-  int dictMatches;
-  char *word, *ptextdup, *delim = " ";
+int checkBestKey(const cs642Text *text, const char *plaintext) {
+  // if all words in plaintext exist in the dictionary
+  return countDictWords(text, plaintext, 1) < 0 ? -1 : 0;
+}
 
-  ptextdup = strdup(plaintext);
-  word = strtok(ptextdup, delim);
-  while (word != NULL) {
-    dictMatches = 0;
-    checkDictionary(word, &dictMatches);
-    if (dictMatches == 0) return -1;
-      word = strtok(NULL, delim);
+// publish a chain's best score into the shared best slot if it beats it
+void publishSubsBest(SubsSearch *search, SubsChain *chain, double score) {
+  int cur = atomic_load(&search->bestChain);
+
+  atomic_store(&chain->bestScore, score);
+  while (cur < 0 || score > atomic_load(&search->chains[cur].bestScore)) {
+    if (atomic_compare_exchange_weak(&search->bestChain, &cur, chain->id))
+      break;
+  }
+}
+
+// count a round that converged on a key, returning 1 once enough independent
+// restarts reached the best key found so far: it is then the optimum of the
+// score, and more restarts would only find it again
+static int confirmSubsKey(SubsSearch *search, const char *roundKey, double score) {
+  int confirmed;
+
+  pthread_mutex_lock(&search->confirmLock);
+  if (strcmp(roundKey, search->confirmKey) == 0) {
+    search->confirmRounds++;
+  } else if (score > search->confirmScore) {
+    strcpy(search->confirmKey, roundKey);
+    search->confirmScore = score;
+    search->confirmRounds = 1;
+  }
+  confirmed = search->confirmRounds >= SUBS_CONFIRM_ROUNDS;
+  pthread_mutex_unlock(&search->confirmLock);
+  return confirmed;
+}
+
+// check if a chain should stop: a key was verified or confirmed, or the time
+// ran out
+static inline int subsSearchDone(SubsSearch *search, int j) {
+  struct timespec now;
+
+  if (atomic_load_explicit(&search->solved, memory_order_relaxed) ||
+      atomic_load_explicit(&search->confirmed, memory_order_relaxed) ||
+      atomic_load_explicit(&search->expired, memory_order_relaxed))
+    return 1;
+  if (search->config.timeMs > 0 && j % SUBS_CLOCK_CHECK == 0) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > search->deadline.tv_sec ||
+        (now.tv_sec == search->deadline.tv_sec && now.tv_nsec >= search->deadline.tv_nsec)) {
+      atomic_store(&search->expired, 1);
+      return 1;
+    }
   }
-  // if all words in plaintext exist in the dictionary
   return 0;
 }
 
+// greedy hill climbing: keep a swap only if it improves the score, ending
+// the round early once no swap has helped for a while since the key is then
+// at a local optimum the polish will confirm
+double climbSubs(SubsChain *chain, int round, char *roundKey) {
+  SubsSearch *search = chain->search;
+  int j, i1, i2, lastGain = 0;
+  double score, bestScore = chain->scorer.score;
+
+  strcpy(roundKey, chain->key);
+  // try permutations of the current key for some time
+  for (j = 0; j < search->config.iters && j - lastGain < SUBS_STALL_ITERS &&
+              !subsSearchDone(search, j); j++) {
+    cs642RandomPair(&chain->rng, NALPHA, &i1, &i2);
+
+    // swap and rescore, and save it if better than best score
+    score = swapSubsScorerKey(&chain->scorer, chain->key, i1, i2);
+    TRACE_SUBS("round-%d (iter: %d of %d) - key: %s, score: %f", round, j, search->config.iters, chain->key, score);
+    if (score > bestScore) {
+      bestScore = score;
+      lastGain = j;
+      strcpy(roundKey, chain->key);
+      TRACE_SUBS("bestKey: %s, bestScore: %f", roundKey, bestScore);
+    } else {
+      // revert the swap
+      undoSubsScorerSwap(&chain->scorer, chain->key, i1, i2);
+    }
+  }
+  return bestScore;
+}
+
+// simulated annealing: accept a worse swap with probability exp(delta / T),
+// cooling T geometrically from a start scaled by the number of 4-grams
+double annealSubs(SubsChain *chain, int round, char *roundKey) {
+  SubsSearch *search = chain->search;
+  int j, i1, i2, iters = search->config.iters;
+  double score, delta, current, bestScore;
+  double temp = SUBS_ANNEAL_TEMP * (chain->scorer.ngrams + 1);
+  double cooling = pow(SUBS_ANNEAL_COOLING, 1.0 / iters);
+
+  current = bestScore = chain->scorer.score;
+  strcpy(roundKey, chain->key);
+  for (j = 0; j < iters && !subsSearchDone(search, j); j++, temp *= cooling) {
+    cs642RandomPair(&chain->rng, NALPHA, &i1, &i2);
+    score = swapSubsScorerKey(&chain->scorer, chain->key, i1, i2);
+    delta = score - current;
+    if (delta >= 0 || cs642RandomUnit(&chain->rng) < exp(delta / temp)) {
+      current = score;
+      if (score > bestScore) {
+        bestScore = score;
+        strcpy(roundKey, chain->key);
+      }
+    } else {
+      undoSubsScorerSwap(&chain->scorer, chain->key, i1, i2);
+    }
+  }
+  return bestScore;
+}
+
+// tabu search: move to the best of a sample of swaps even if it is worse,
+// forbidding recently swapped position pairs unless they beat the best key
+double tabuSubs(SubsChain *chain, int round, char *roundKey) {
+  SubsSearch *search = chain->search;
+  int c, j = 0, step = 0, i1, i2, m1, m2;
+  int tabu[NALPHA][NALPHA] = {{0}};
+  double score, moveScore, bestScore = chain->scorer.score;
+
+  strcpy(roundKey, chain->key);
+  while (j < search->config.iters && !subsSearchDone(search, j)) {
+    // evaluate a candidate list of swaps, undoing each one
+    m1 = -1;
+    moveScore = -INFINITY;
+    for (c = 0; c < SUBS_TABU_CANDIDATES && j < search->config.iters; c++, j++) {
+      cs642RandomPair(&chain->rng, NALPHA, &i1, &i2);
+      score = swapSubsScorerKey(&chain->scorer, chain->key, i1, i2);
+      undoSubsScorerSwap(&chain->scorer, chain->key, i1, i2);
+      if ((tabu[i1][i2] <= step || score > bestScore) && score > moveScore) {
+        moveScore = score;
+        m1 = i1;
+        m2 = i2;
+      }
+    }
+    if (m1 < 0) continue;
+
+    // take the move and make its reversal tabu for a while
+    swapSubsScorerKey(&chain->scorer, chain->key, m1, m2);
+    tabu[m1][m2] = tabu[m2][m1] = ++step + SUBS_TABU_TENURE;
+    if (moveScore > bestScore) {
+      bestScore = moveScore;
+      strcpy(roundKey, chain->key);
+    }
+  }
+  return bestScore;
+}
+
+// polish a round key by taking every improving swap until none is left
+double polishSubs(SubsChain *chain, char *roundKey) {
+  int i1, i2, improved = 1;
+  double score, bestScore;
+
+  strcpy(chain->key, roundKey);
+  bestScore = setSubsScorerKey(&chain->scorer, chain->key);
+  while (improved) {
+    improved = 0;
+    for (i1 = 0; i1 < NALPHA - 1; i1++) {
+      for (i2 = i1 + 1; i2 < NALPHA; i2++) {
+        score = swapSubsScorerKey(&chain->scorer, chain->key, i1, i2);
+        if (score > bestScore) {
+          bestScore = score;
+          improved = 1;
+        } else {
+          undoSubsScorerSwap(&chain->scorer, chain->key, i1, i2);
+        }
+      }
+    }
+  }
+  strcpy(roundKey, chain->key);
+  return bestScore;
+}
+
+// run restarts of the configured strategy on one chain until the rounds run
+// out, the time budget expires or any chain finds a key whose plaintext is
+// all dictionary words
+void *runSubsChain(void *arg) {
+  SubsChain *chain = arg;
+  SubsSearch *search = chain->search;
+  int i;
+  double bestScore;
+  char roundKey[NALPHA + 1];
+
+  uint64_t start;
+
+  while (!subsSearchDone(search, 0) &&
+         (i = atomic_fetch_add(&search->nextRound, 1)) < search->maxRounds) {
+    start = cs642StatNow();
+    cs642StatCount(CS642_COUNT_RESTARTS, 1);
+    // the first round starts from the frequency derived key, later ones at random
+    if (i == 0) strcpy(chain->key, search->freqKey);
+    else generateRandomKey(chain->key, &chain->rng);
+    setSubsScorerKey(&chain->scorer, chain->key);
+
+    // a key seeded from word patterns is mostly right, so only polish it
+    if (i == 0 && search->seeded) strcpy(roundKey, chain->key);
+    else switch (search->config.strategy) {
+    case SUBS_ANNEALING:
+      bestScore = annealSubs(chain, i, roundKey);
+      break;
+    case SUBS_TABU:
+      bestScore = tabuSubs(chain, i, roundKey);
+      break;
+    default:
+      bestScore = climbSubs(chain, i, roundKey);
+      break;
+    }
+    bestScore = polishSubs(chain, roundKey);
+    cs642StatTime(CS642_PHASE_SCORING, start);
+    logMessage(CipherVerboseLevel, "[round #%d complete] bestKey: %s, bestScore: %f", i, roundKey, bestScore);
+    if (bestScore > atomic_load(&chain->bestScore)) {
+      strcpy(chain->bestKey, roundKey);
+      publishSubsBest(search, chain, bestScore);
+    }
+
+    // decrypt using the round key & check if the plaintext contains words in the dict
+    decryptSUBSLetters(search->letters, search->clen, roundKey, chain->scratch.text);
+    if (checkBestKey(search->text, chain->scratch.text) == 0) {
+      strcpy(chain->bestKey, roundKey);
+      chain->solved = 1;
+      atomic_store(&search->solved, 1);
+    } else if (confirmSubsKey(search, roundKey, bestScore)) {
+      atomic_store(&search->confirmed, 1);
+    }
+  }
+  // chains run on their own threads, which exit with the search
+  cs642FlushStats();
+  return NULL;
+}
+
+// get the number of SUBS chains to run in parallel
+int getSubsThreads(SubsConfig *config) {
+  long n = config->threads > 0 ? config->threads : sysconf(_SC_NPROCESSORS_ONLN);
+  if (n < 1) n = 1;
+  if (n > config->rounds) n = config->rounds;
+  if (n > SUBS_MAX_THREADS) n = SUBS_MAX_THREADS;
+  return (int)n;
+}
+
+// decrypt normalized ciphertext with a Vigenere or substitution key
+static void decryptLetters(cs642Cipher cipher, const uint8_t *letters, int clen,
+                           const char *key, char *out) {
+  if (cipher == CIPHER_VIGE) decryptVIGELetters(letters, clen, key, strlen(key), out);
+  else decryptSUBSLetters(letters, clen, key, out);
+}
+
+// search a normalized ciphertext through the result cache: a repeated
+// ciphertext costs a lookup and one decryption, and a new one is first tried
+// with the most recently recovered keys, only searching if none decrypts it
+// confidently
+static int searchCached(cs642Cipher cipher, KeySearch search, const cs642Text *text,
+                        char *plaintext, int plen, char *key) {
+  char known[CACHE_TRY_KEYS][CS642_CACHE_KEY_MAX + 1];
+  Scratch scratch = {0};
+  uint64_t hash;
+  double score;
+  int i, n, r = -1, confident = 0, clen = text->len;
+  // the callers size key for the longest key the analyzer itself returns
+  int keyMax = cipher == CIPHER_VIGE ? vigeConfig.maxKeysize : NALPHA;
+
+  if (!cs642CacheEnabled()) return search(text, plaintext, plen, key);
+
+  hash = cs642CacheHash(text->letters, clen);
+  if (cs642CacheLookup(cipher, hash, clen, key, keyMax, &score) == 0) {
+    analysisIterations = 0;
+    logMessage(CipherVerboseLevel, "cached key: %s, score: %f", key, score);
+    return cs642Decrypt(cipher, key, strlen(key), plaintext, plen, text->canon, clen) ? -1 : 0;
+  }
+  if (initScratch(&scratch, clen) == 0) {
+    n = cs642CacheKnownKeys(cipher, known, CACHE_TRY_KEYS, keyMax);
+    for (i = 0; i < n && !confident; i++) {
+      decryptLetters(cipher, text->letters, clen, known[i], scratch.text);
+      confident = confidentDecryption(text, scratch.text);
+    }
+    if (confident) {
+      memcpy(key, known[i - 1], strlen(known[i - 1]) + 1);
+      analysisIterations = i;
+      logMessage(CipherVerboseLevel, "known key: %s", key);
+      r = cs642Decrypt(cipher, key, strlen(key), plaintext, plen, text->canon, clen) ? -1 : 0;
+    } else if ((r = search(text, plaintext, plen, key)) == 0) {
+      decryptLetters(cipher, text->letters, clen, key, scratch.text);
+      confident = confidentDecryption(text, scratch.text);
+    }
+    // an unconfident key may be a search that went wrong, it is searched
+    // again next time rather than replayed
+    if (r == 0 && confident)
+      cs642CacheStore(cipher, hash, clen, key, cs642ScorePlaintext(scratch.text));
+  } else {
+    // without scratch space known keys cannot be tried, the key is still searched
+    r = search(text, plaintext, plen, key);
+  }
+  freeScratch(&scratch);
+  return r;
+}
+
+// search the rotation of a ciphertext
+static int searchROTXKey(const cs642Text *text, char *plaintext, int plen, uint8_t *key) {
+
+  int i, j, dictMatches, words, r, clen = text->len;
+  uint8_t k, order[NALPHA];
+  int maxMatches = 0;
+  uint32_t freqs[NALPHA];
+  double chiScores[NALPHA];
+  Scratch scratch;
+  uint64_t start;
+
+  if (initScratch(&scratch, clen)) return -1;
+
+  // rank all rotations by the Chi Squared value of a single histogram
+  start = cs642StatNow();
+  letterHistogram(text->letters, clen, 0, freqs);
+  cs642StatTime(CS642_PHASE_HISTOGRAM, start);
+  chiSquaredShifts(freqs, dictLetterProbs, chiScores);
+  for (i = 0; i < NALPHA - 1; i++) {
+    for (j = i; j > 0 && chiScores[order[j - 1]] > chiScores[i + 1]; j--) {
+      order[j] = order[j - 1];
+    }
+    order[j] = i + 1;
+  }
+
+  // test rotations from the most likely, taking the first one at once if it
+  // is certainly right and otherwise stopping once every word is in the dict;
+  // if no rotation matches a word the best Chi Squared one is kept
+  words = text->nwords;
+  *key = order[0];
+  for (i = 0; i < NALPHA - 1; i++) {
+    k = order[i];
+    decryptROTXLetters(text->letters, clen, k, scratch.text);
+    if (i == 0 && confidentDecryption(text, scratch.text)) {
+      *key = k;
+      break;
+    }
+    // select rotation with highest dict word matches, giving up on it once
+    // it has missed too many words to beat the best one
+    dictMatches = countDictWords(text, scratch.text, words - maxMatches);
+    if (dictMatches > maxMatches) {
+      maxMatches = dictMatches;
+      *key = k;
+    }
+    if (dictMatches == words) break;
+  }
+  analysisIterations = i < NALPHA - 1 ? i + 1 : i;
+  freeScratch(&scratch);
+  if ((r = cs642Decrypt(CIPHER_ROTX, (char*)key, strlen((char*)key), plaintext, plen, text->canon, clen)) == 0)
+    return 0;
+
+  return -1;
+}
+
+// analyze a raw ciphertext: normalize it once for the search, then put its
+// case and punctuation back on the plaintext
+static int analyzeCached(cs642Cipher cipher, KeySearch search, char *ciphertext,
+                         int clen, char *plaintext, int plen, char *key) {
+  cs642Text text;
+  int r;
+
+  if (cs642ParseText(&text, ciphertext, clen)) return -1;
+  if ((r = searchCached(cipher, search, &text, plaintext, plen, key)) == 0)
+    cs642RestoreText(&text, plaintext, plen);
+  cs642FreeText(&text);
+  return r;
+}
+
 //
 // Functions
 
@@ -334,6 +1294,16 @@ int checkBestKey(char *plaintext) {
 // Outputs      : 0 if successful, -1 if failure
 
 int cs642StudentInit(void) {
+  // index the dictionary once for constant time word lookups
+  initKernels();
+  if (buildDictIndex()) return (-1);
+  // the letter probabilities used by the Chi Squared tests and the 4-gram
+  // log probabilities used to score SUBS candidates come from the model
+  if (loadLangModel()) return (-1);
+  // the word patterns of the dictionary seed the SUBS keys
+  if (cs642BuildPatternIndex()) return (-1);
+  // repeated ciphertexts and keys are answered from the result cache
+  if (cs642InitCache(cacheEntries, cachePath, vigeConfig.maxKeysize)) return (-1);
   return (0);
 }
 
@@ -351,35 +1321,192 @@ int cs642StudentInit(void) {
 
 int cs642PerformROTXCryptanalysis(char *ciphertext, int clen, char *plaintext,
                                   int plen, uint8_t *key) {
+  cs642Text text;
+  int r;
+
+  if (cs642ParseText(&text, ciphertext, clen)) return -1;
+  if ((r = searchROTXKey(&text, plaintext, plen, key)) == 0)
+    cs642RestoreText(&text, plaintext, plen);
+  cs642FreeText(&text);
+  return r;
+}
 
-  int i, dictMatches, r;
-  uint8_t k;
-  char *decryption = strdup(ciphertext);
-  char *decryptionDup, *tok, *delim = " ";
-  int maxMatches = 0;
+// search the Vigenere key of a ciphertext
+static int searchVIGEKey(const cs642Text *text, char *plaintext, int plen, char *key) {
+
+  int i, r, words, matches, bestMatches = -1, bestKeysize = 0, nranked = 0;
+  int clen = text->len;
+  const uint8_t *letters = text->letters;
+  int confident = 0;
+  int ranked[VIGE_KEYSIZE_LIMIT];
+  VigeConfig config = vigeConfig; // one consistent view for this ciphertext
+  char *candidate = malloc(config.maxKeysize + 1);
+  Scratch scratch = {0};
+  ColumnHists hists = {0};
+  uint64_t start;
+
+  // histogram the columns of every key size in one pass over the letters
+  if (candidate != NULL && initScratch(&scratch, clen) == 0) {
+    r = buildColumnHists(&hists, letters, clen, config.minKeysize, config.maxKeysize);
+  } else {
+    r = -1;
+  }
 
-  // test all possible rotations
-  for (k = 1; k < NALPHA; k++) {
-    for (i = 0; i < clen; i++) {
-      if (ciphertext[i] == ' ')
-        continue;
-      decryption[i] = rotByX(ciphertext[i], k);
-    }
-    decryptionDup = strdup(decryption);
-    tok = strtok(decryptionDup, delim);
-    dictMatches = 0;
-    while (tok != NULL) {
-      // select rotation with highest dict word matches
-      checkDictionary(tok, &dictMatches);
-      if (dictMatches > maxMatches) {
-        maxMatches = dictMatches;
-        *key = k;
-        strcpy(plaintext, decryption);
-      }
-      tok = strtok(NULL, delim);
+  // shortlist the most likely key sizes, only those are solved
+  if (r == 0) {
+    start = cs642StatNow();
+    nranked = rankVIGEKeysizes(&hists, letters, clen, ranked, config.topk);
+    cs642StatTime(CS642_PHASE_KEYLEN, start);
+  }
+
+  // solve each shortlisted key size, taking the first one at once if its
+  // decryption is certainly right and otherwise keeping the key whose
+  // decryption has the most dictionary words, stopping once all of them are
+  words = text->nwords;
+  for (i = 0; i < nranked && bestMatches < words && !confident; i++) {
+    solveVIGEColumns(&hists, ranked[i], candidate);
+    decryptVIGELetters(letters, clen, candidate, ranked[i], scratch.text);
+    if (i == 0 && (confident = confidentDecryption(text, scratch.text))) {
+      bestKeysize = ranked[i];
+      strcpy(key, candidate);
+      continue;
+    }
+    // short columns may have picked wrong letters, fix them on the text
+    refineVIGEKey(&hists, letters, clen, ranked[i], candidate, scratch.text);
+    decryptVIGELetters(letters, clen, candidate, ranked[i], scratch.text);
+    // give up on a key once it has missed too many words to beat the best one
+    matches = countDictWords(text, scratch.text, bestMatches < 0 ? 0 : words - bestMatches);
+    if (matches > bestMatches) {
+      bestMatches = matches;
+      bestKeysize = ranked[i];
+      strcpy(key, candidate);
     }
   }
-  if ((r = cs642Decrypt(CIPHER_ROTX, (char*)key, strlen((char*)key), plaintext, plen, ciphertext, clen)) == 0)
+  analysisIterations = i;
+  freeColumnHists(&hists);
+  freeScratch(&scratch);
+  free(candidate);
+  if (bestKeysize == 0) return -1;
+
+  if ((r = cs642Decrypt(CIPHER_VIGE, key, bestKeysize, plaintext, plen, text->canon, clen) == 0))
+    return 0;
+
+  return -1;
+}
+
+// search the substitution key of a ciphertext
+static int searchSUBSKey(const cs642Text *text, char *plaintext, int plen, char *key) {
+
+  int i, r, nthreads, mapped, started = 0, best = -1, clen = text->len;
+  char freqKey[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  SubsSearch search;
+  SubsChain *chains;
+  pthread_t *threads;
+  struct timespec start, end, now;
+  uint64_t seed, chainSeed;
+
+  // start with a frequency derived key, completing the words whose letter
+  // patterns pin down their plaintext
+  getInitFreqDerivedKey(text, freqKey);
+  mapped = getPatternSeededKey(text, freqKey);
+
+  // set up independent chains, each indexing the ciphertext 4-grams itself;
+  // the chains live on the heap and share the model, so a search only needs
+  // a few hundred bytes of stack and can run on any worker thread
+  memset(&search, 0, sizeof(SubsSearch));
+  search.config = subsConfig;
+  nthreads = getSubsThreads(&search.config);
+  chains = calloc(nthreads, sizeof(SubsChain));
+  threads = malloc(nthreads * sizeof(pthread_t));
+  if (chains == NULL || threads == NULL) {
+    free(chains);
+    free(threads);
+    return -1;
+  }
+  search.model = cs642RetainModel(langModel);
+  // every chain decrypts from the same normalized letters
+  search.text = text;
+  search.letters = text->letters;
+  search.clen = clen;
+  search.freqKey = freqKey;
+  search.seeded = mapped >= SUBS_SEED_MIN_LETTERS;
+  search.chains = chains;
+  atomic_init(&search.nextRound, 0);
+  atomic_init(&search.solved, 0);
+  atomic_init(&search.confirmed, 0);
+  atomic_init(&search.expired, 0);
+  atomic_init(&search.bestChain, -1);
+  search.maxRounds = search.config.rounds;
+  pthread_mutex_init(&search.confirmLock, NULL);
+  search.confirmScore = -INFINITY;
+  // the n-th analysis uses the configured seed plus n, logged so a run can be
+  // replayed; without one, concurrent analyses still get distinct seeds
+  seed = atomic_fetch_add(&subsSearches, 1);
+  if (subsSeed) {
+    seed += subsSeed;
+  } else {
+    clock_gettime(CLOCK_REALTIME, &now);
+    seed = ((uint64_t)now.tv_sec * 1000000000u + now.tv_nsec) ^ (seed * 0x9E3779B97F4A7C15ull);
+  }
+  logMessage(CipherVerboseLevel, "SUBS search seed: %llu", (unsigned long long)seed);
+  chainSeed = seed;
+  for (i = 0; i < nthreads; i++) {
+    chains[i].search = &search;
+    chains[i].id = i;
+    cs642SeedRandom(&chains[i].rng, cs642SplitMix64(&chainSeed));
+    atomic_init(&chains[i].bestScore, -INFINITY);
+    strcpy(chains[i].bestKey, freqKey);
+    if (initScratch(&chains[i].scratch, clen) || initSubsScorer(&chains[i].scorer, search.model, text->letters, clen)) {
+      nthreads = i + 1;
+      goto cleanup;
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  search.deadline.tv_sec = start.tv_sec + search.config.timeMs / 1000;
+  search.deadline.tv_nsec = start.tv_nsec + (search.config.timeMs % 1000) * 1000000L;
+  if (search.deadline.tv_nsec >= 1000000000L) {
+    search.deadline.tv_sec++;
+    search.deadline.tv_nsec -= 1000000000L;
+  }
+  // the first chain runs on the calling thread, so a single chain search
+  // never starts a thread, and only the other chains get one each
+  for (started = 1; started < nthreads; started++) {
+    if (pthread_create(&threads[started], NULL, runSubsChain, &chains[started])) break;
+  }
+  runSubsChain(&chains[0]);
+  for (i = 1; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  // prefer a chain whose key was verified, else the best scoring one
+  best = atomic_load(&search.bestChain);
+  for (i = 0; i < nthreads; i++) {
+    if (chains[i].solved) {
+      best = i;
+      logMessage(CipherVerboseLevel, "key successfully recovered! (took: %0.5f sec)",
+             (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+      break;
+    }
+  }
+  strcpy(key, chains[best < 0 ? 0 : best].bestKey);
+
+cleanup:
+  analysisIterations = 0;
+  for (i = 0; i < nthreads; i++) {
+    analysisIterations += chains[i].scorer.evals;
+    freeSubsScorer(&chains[i].scorer);
+    freeScratch(&chains[i].scratch);
+  }
+  pthread_mutex_destroy(&search.confirmLock);
+  cs642ReleaseModel(search.model);
+  free(chains);
+  free(threads);
+  if (best < 0) return -1;
+
+  // decrypt using the best key
+  if ((r = cs642Decrypt(CIPHER_SUBS, key, NALPHA, plaintext, plen, text->canon, clen) == 0))
     return 0;
 
   return -1;
@@ -399,74 +1526,8 @@ int cs642PerformROTXCryptanalysis(char *ciphertext, int clen, char *plaintext,
 
 int cs642PerformVIGECryptanalysis(char *ciphertext, int clen, char *plaintext,
                                   int plen, char *key) {
-
-  int i, j, k, N, r;
-  int rows, cols, dictLetters;
-  int dictFreqs[NALPHA] = {0};
-  char chr;
-  char *subcipher, *finalKey;
-  char **cipherMatrix, **maxFriedmanMatrix;
-  int keysize, maxFriedmanKeysize = 0;
-  double friedman, friedmanAvg;
-  double maxFriedmanAvg = -INFINITY;
-  double chiScore, minChiScore;
-
-  // test all possible key sizes
-  for (keysize = MIN_KEYSIZE; keysize < MAX_KEYSIZE; keysize++) {
-    rows = keysize;
-    cols = (clen % rows) == 0 ? (clen / rows): (clen / rows + 1);
-    // transposed matrix - each row is a rotx cipher
-    cipherMatrix = malloc(rows * sizeof(char*));
-    createCipherMatrix(ciphertext, clen, rows, cols, cipherMatrix, 1);
-    friedman = friedmanTotal(cipherMatrix, clen, rows, cols);
-    friedmanAvg = friedman / rows;
-    if (friedmanAvg > maxFriedmanAvg) {
-      maxFriedmanAvg = friedmanAvg;
-      maxFriedmanKeysize = keysize;
-    }
-    freev((void*)cipherMatrix, rows, 1);
-  }
-
-  // reconstruct matrix with found key size
-  rows = maxFriedmanKeysize;
-  cols = (clen % rows) == 0 ? (clen / rows): (clen / rows + 1);
-  maxFriedmanMatrix = malloc(rows * sizeof(char*));
-  createCipherMatrix(ciphertext, clen, rows, cols, maxFriedmanMatrix, 1);
-
-  // fetch dictionary frequencies
-  dictLetters = getDictLetterFreqs(dictFreqs);
-  // brute-force the key with most-probable keysize
-  finalKey = malloc(rows * sizeof(char));
-  for (i = 0; i < rows; i++) {
-    subcipher = strdup(maxFriedmanMatrix[i]);
-    minChiScore = INFINITY;
-    for (k = 0; k < NALPHA; k++) {
-      N = 0;
-      // each row is rotx cipher in transposed matrix
-      for (j = 0; j < strlen(subcipher); j++) {
-        chr = maxFriedmanMatrix[i][j];
-        if (isupper(chr)) {
-          subcipher[j] = rotByX(chr, k);
-          N++;
-        }
-      }
-      // compute Chi Squared value & reconstruct key
-      chiScore = chiSquared(subcipher, N, dictFreqs, dictLetters);
-      if (chiScore < minChiScore) {
-        minChiScore = chiScore;
-        finalKey[i] = (char)((int)'A' + k);
-      }
-    }
-  }
-  finalKey[i] = '\0';
-  strcpy(key, finalKey);
-  free(finalKey);
-  freev((void*)maxFriedmanMatrix, rows, 1);
-
-  if ((r = cs642Decrypt(CIPHER_VIGE, key, maxFriedmanKeysize, plaintext, plen, ciphertext, clen) == 0))
-    return 0;
-
-  return -1;
+  return analyzeCached(CIPHER_VIGE, searchVIGEKey, ciphertext, clen, plaintext,
+                       plen, key);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -483,72 +1544,231 @@ int cs642PerformVIGECryptanalysis(char *ciphertext, int clen, char *plaintext,
 
 int cs642PerformSUBSCryptanalysis(char *ciphertext, int clen, char *plaintext,
                                   int plen, char *key) {
+  return analyzeCached(CIPHER_SUBS, searchSUBSKey, ciphertext, clen, plaintext,
+                       plen, key);
+}
 
-  int i, j, dngcnt, i1, i2, r;
-  char dictNGrams[MAX_NGRAMS][NGRAMSIZE];
-  double dictNGramProbs[MAX_NGRAMS];
-  double score, bestScore = -INFINITY;
-  char freqKey[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ", bestKey[NALPHA];
-  char subsKey[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-  clock_t start, end;
-
-  // pre-compute dictionary ngrams and their probabilities
-  dngcnt = getDictNGrams(dictNGrams);
-  for (i = 0; i < dngcnt; i++) {
-    dictNGramProbs[i] = getNGramProb(dictNGrams[i], dictNGrams, dngcnt);
-  }
-
-  // start with a frequency derived key
-  getInitFreqDerivedKey(ciphertext, clen, freqKey);
-
-  srand(time(NULL));
-  start = clock();
-  for (i = 0; i < SUBS_ITERS; i++) {
-    /*if (i > 0) generateRandomKey(subsKey);*/
-    strcpy(subsKey, freqKey);
-    bestScore = -INFINITY;
-    // try permutations of the current key for some time
-    for (j = 0; j < SUBS_SUBITERS; j++) {
-      // choose random indices to swap
-      i1 = rand() % NALPHA;
-      i2 = rand() % NALPHA;
-      while (i1 == i2)
-        i2 = rand() % NALPHA;
-
-      // swap
-      swap(i1, i2, subsKey);
-
-      // decrypt and get score, and save it if better than best score
-      cs642Decrypt(CIPHER_SUBS, subsKey, NALPHA, plaintext, plen, ciphertext, clen);
-      score = cipherNGPSum(plaintext, dictNGrams, dictNGramProbs, dngcnt);
-      printf("[LOG] round-%d (iter: %d of %d) - key: %s, score: %f\n", i, j, SUBS_SUBITERS, subsKey, score);
-      if (score > bestScore) {
-        bestScore = score;
-        strcpy(bestKey, subsKey);
-        printf("[LOG] bestKey: %s, bestScore: %f\n", bestKey, bestScore);
-      } else {
-        // revert the swap
-        swap(i1, i2, subsKey);
-      }
-    }
-    printf("[LOG] [round #%d complete] bestKey: %s, bestScore: %f\n", i, bestKey, bestScore);
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642ScorePlaintext
+// Description  : This scores how much a plaintext looks like the dictionary
+//                text, as its average 4-gram log probability
+//
+// Inputs       : plaintext - the plaintext to score
+// Outputs      : the average log probability, or the floor value if the
+//                plaintext has no 4-grams
 
-    // decrypt using the best key & check if the plaintext contains words in the dict
-    cs642Decrypt(CIPHER_SUBS, bestKey, NALPHA, plaintext, plen, ciphertext, clen);
-    if (checkBestKey(plaintext) == 0) {
-      strcpy(key, bestKey);
-      end = clock();
-      printf("[LOG] key successfully recovered! (took: %0.5f sec)\n", ((double)(end - start) / CLOCKS_PER_SEC));
-      return 0;
-    }
+double cs642ScorePlaintext(char *plaintext) {
+  int n;
+  uint64_t start = cs642StatNow();
+  double sum = cipherNGPSum(plaintext, &n);
+
+  cs642StatTime(CS642_PHASE_SCORING, start);
+  return n > 0 ? sum / n : ngramFloor;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642ClassifyCiphertext
+// Description  : This guesses the cipher of a ciphertext from one letter
+//                histogram: a histogram that is English under some shift is
+//                a ROT-X, a flattened one (IC nearer Kr than Kp) a Vigenere
+//                and an English shaped but permuted one a substitution. ICs
+//                close to the cut are settled by the periodic IC over the
+//                Vigenere key lengths.
+//
+// Inputs       : ciphertext - the ciphertext to classify
+//                clen - the length of the ciphertext
+//                order - the place to put the ciphers to try, the most
+//                        likely first and the others cheapest first
+// Outputs      : the most likely cipher
+
+cs642Cipher cs642ClassifyCiphertext(char *ciphertext, int clen,
+                                    cs642Cipher order[CIPHER_UNK]) {
+  int i, j;
+  uint32_t counts[NALPHA] = {0};
+  double n = 0, ic = 0, minChi = INFINITY, chi[NALPHA];
+  VigeConfig config = vigeConfig;
+  cs642Cipher best;
+  cs642Text text;
+  uint64_t start;
+
+  // a text that cannot be normalized has no letters, and is tried as a ROT-X
+  if (cs642ParseText(&text, ciphertext, clen) == 0) {
+    start = cs642StatNow();
+    letterHistogram(text.letters, clen, 0, counts);
+    cs642StatTime(CS642_PHASE_HISTOGRAM, start);
+  }
+  for (i = 0; i < NALPHA; i++) {
+    n += counts[i];
+    ic += counts[i] * (counts[i] - 1.0);
+  }
+  ic = n > 1 ? ic / (n * (n - 1)) : 0;
+  chiSquaredShifts(counts, dictLetterProbs, chi);
+  for (i = 0; i < NALPHA; i++) {
+    if (chi[i] < minChi) minChi = chi[i];
   }
 
-  // decrypt using the best key
-  strcpy(key, bestKey);
-  if ((r = cs642Decrypt(CIPHER_SUBS, key, NALPHA, plaintext, plen, ciphertext, clen) == 0))
-    return 0;
+  if (n < 2 || minChi / n < CLASSIFY_ROTX_CHI) {
+    best = CIPHER_ROTX;
+  } else if (fabs(ic - CLASSIFY_VIGE_IC) < CLASSIFY_IC_BAND) {
+    best = bestPeriodicIC(text.letters, clen, &config) - ic > CLASSIFY_PERIODIC_GAIN
+               ? CIPHER_VIGE : CIPHER_SUBS;
+  } else {
+    best = ic < CLASSIFY_VIGE_IC ? CIPHER_VIGE : CIPHER_SUBS;
+  }
 
-  return -1;
+  // the analyzers cost ROT-X < Vigenere < substitution, in enum order
+  order[0] = best;
+  for (i = CIPHER_ROTX, j = 1; i < CIPHER_UNK; i++) {
+    if (i != best) order[j++] = i;
+  }
+  cs642FreeText(&text);
+  return best;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642DictWordShare
+// Description  : This gets the share of the words of a plaintext that are in
+//                the dictionary
+//
+// Inputs       : plaintext - the plaintext to check
+// Outputs      : the share of dictionary words, 0 if there are no words
+
+double cs642DictWordShare(char *plaintext) {
+  cs642Text text;
+  double share = 0;
+
+  if (cs642ParseText(&text, plaintext, strlen(plaintext))) return 0;
+  if (text.nwords > 0) share = (double)countDictWords(&text, text.canon, 0) / text.nwords;
+  cs642FreeText(&text);
+  return share;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642AnalysisIterations
+// Description  : This gets the search iterations the last analysis run on the
+//                calling thread took: rotations tried for ROT-X, key lengths
+//                solved for Vigenere, and key swaps scored for substitution
+//
+// Inputs       : void
+// Outputs      : the number of iterations
+
+long cs642AnalysisIterations(void) { return analysisIterations; }
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SetSUBSSearch
+// Description  : This configures the search used to cryptanalyze the
+//                substitution cipher
+//
+// Inputs       : strategy - the search strategy to run on each restart
+//                rounds - the number of restarts
+//                iters - the number of key evaluations per restart
+//                timeMs - the wall-clock budget per ciphertext (0 for none)
+//                threads - the number of parallel chains (0 for one per CPU)
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642SetSUBSSearch(cs642SubsStrategy strategy, int rounds, int iters,
+                       int timeMs, int threads) {
+  if (strategy < SUBS_HILLCLIMB || strategy >= SUBS_STRATEGY_MAX ||
+      rounds < 1 || iters < 1 || timeMs < 0 || threads < 0)
+    return (-1);
+
+  subsConfig.strategy = strategy;
+  subsConfig.rounds = rounds;
+  subsConfig.iters = iters;
+  subsConfig.timeMs = timeMs;
+  subsConfig.threads = threads;
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SetScoreMode
+// Description  : This sets how the 4-gram log probabilities are summed, as
+//                floats or as int16 fixed point from the quantized table
+//
+// Inputs       : mode - the scoring mode
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642SetScoreMode(cs642ScoreMode mode) {
+  if (mode < CS642_SCORE_FLOAT || mode >= CS642_SCORE_MAX) return (-1);
+  scoreMode = mode;
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SetSUBSSeed
+// Description  : This sets the seed of the substitution searches, the n-th
+//                analysis started using seed + n; a search with one chain
+//                then replays exactly from the seed it logged
+//
+// Inputs       : seed - the seed, 0 to seed each search from the clock
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642SetSUBSSeed(uint64_t seed) {
+  subsSeed = seed;
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SetVIGESearch
+// Description  : This configures the key length search used to cryptanalyze
+//                the Vigenere cipher
+//
+// Inputs       : minKeysize - the shortest key length considered
+//                maxKeysize - the longest key length considered
+//                topk - the number of best ranked key lengths fully solved
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642SetVIGESearch(int minKeysize, int maxKeysize, int topk) {
+  if (minKeysize < 1 || maxKeysize < minKeysize ||
+      maxKeysize > VIGE_KEYSIZE_LIMIT || topk < 1)
+    return (-1);
+
+  vigeConfig.minKeysize = minKeysize;
+  vigeConfig.maxKeysize = maxKeysize;
+  vigeConfig.topk = topk;
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SetModelFile
+// Description  : This sets the language model file mapped by
+//                cs642StudentInit, the model is counted from the dictionary
+//                if the file is missing or invalid
+//
+// Inputs       : path - the model file
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642SetModelFile(const char *path) {
+  if (path == NULL || *path == '\0') return (-1);
+  modelPath = path;
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SetCache
+// Description  : This sets the size of the result cache set up by
+//                cs642StudentInit, and the file its results are reloaded
+//                from and appended to
+//
+// Inputs       : entries - the number of results kept, 0 to disable the cache
+//                path - the cache file, or NULL to keep results in memory
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642SetCache(int entries, const char *path) {
+  if (entries < 0 || (path != NULL && *path == '\0')) return (-1);
+  cacheEntries = entries;
+  cachePath = path;
+  return (0);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -564,7 +1784,21 @@ int cs642PerformSUBSCryptanalysis(char *ciphertext, int clen, char *plaintext,
 
 int cs642StudentCleanUp(void) {
 
-  // ADD CODE HERE IF NEEDED
+  // release the dictionary index
+  free(dictIndex);
+  dictIndex = NULL;
+  dictIndexMask = 0;
+
+  // drop the reference to the language model, searches still running keep
+  // their own
+  cs642ReleaseModel(langModel);
+  langModel = NULL;
+  ngramLogProbs = NULL;
+  ngramFixed = NULL;
+
+  // release the word-pattern index and the result cache
+  cs642FreePatternIndex();
+  cs642FreeCache();
 
   // Return successfully
   return (0);
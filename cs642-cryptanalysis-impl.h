@@ -9,6 +9,33 @@
 
 // Include Files
 
+//
+// Type definitions
+
+// Search strategies for the substitution cipher
+typedef enum {
+  SUBS_HILLCLIMB = 0,    // Random-restart hill climbing
+  SUBS_ANNEALING = 1,    // Simulated annealing
+  SUBS_TABU = 2,         // Tabu search
+  SUBS_STRATEGY_MAX = 3  // Maximum number of strategies
+} cs642SubsStrategy;
+
+// How n-gram log probabilities are summed
+typedef enum {
+  CS642_SCORE_FLOAT = 0, // Float table, double sums
+  CS642_SCORE_FIXED = 1, // Quantized int16 table, integer sums
+  CS642_SCORE_MAX = 2    // Maximum number of modes
+} cs642ScoreMode;
+
+//
+// External declarations
+
+extern const char *cs642SubsStrategyStrings[];
+// The strategy strings for printing and parsing
+
+extern const char *cs642ScoreModeStrings[];
+// The scoring mode strings for printing and parsing
+
 //
 // Implementation functions
 
@@ -28,7 +55,66 @@ int cs642PerformSUBSCryptanalysis(char *ciphertext, int clen, char *plaintext,
                                   int plen, char *key);
 // This is the function to cryptanalyze the substitution cipher
 
+double cs642ScorePlaintext(char *plaintext);
+// This scores a plaintext as its average 4-gram log probability, higher
+// scores look more like the dictionary text
+
+cs642Cipher cs642ClassifyCiphertext(char *ciphertext, int clen,
+                                    cs642Cipher order[CIPHER_UNK]);
+// This guesses the cipher of a ciphertext from its letter statistics, and
+// puts the order to try the analyzers in, the most likely first
+
+double cs642DictWordShare(char *plaintext);
+// This gets the share of the words of a plaintext that are in the dictionary
+
+long cs642AnalysisIterations(void);
+// This gets the search iterations of the last analysis run on the calling
+// thread: rotations tried for ROT-X, key lengths solved for Vigenere and key
+// swaps scored for the substitution cipher
+
+int cs642SetSUBSSearch(cs642SubsStrategy strategy, int rounds, int iters,
+                       int timeMs, int threads);
+// This configures the substitution search: the strategy, the number of
+// restarts, the key evaluations per restart, a wall-clock budget in ms (0 for
+// none) and the number of parallel chains (0 for one per CPU); set it before
+// any analysis starts, the analyzers read it without locking. A search stops
+// early once restarts converge on one key
+
+int cs642SetScoreMode(cs642ScoreMode mode);
+// This sets how the analyzers sum 4-gram log probabilities: as floats, or in
+// fixed point from an int16 copy of the table made with the model, which is
+// half the size and sums in integers; set it before cs642StudentInit
+
+int cs642SetSUBSSeed(uint64_t seed);
+// This sets the seed of the substitution searches (0 to seed each one from
+// the clock); the n-th analysis uses seed + n and logs it, so a search run
+// on one thread is replayed by passing its logged seed
+
+int cs642SetVIGESearch(int minKeysize, int maxKeysize, int topk);
+// This configures the Vigenere key length search: the range of key lengths
+// ranked by Kasiski examination and column IC, and how many of the best
+// ranked lengths are fully solved
+
+int cs642SetModelFile(const char *path);
+// This sets the language model file mapped by cs642StudentInit, which falls
+// back to counting the dictionary if the file is missing or invalid
+
+int cs642SetCache(int entries, const char *path);
+// This sets the size of the result cache set up by cs642StudentInit (0
+// disables it) and the file its results are reloaded from and appended to
+// (NULL to keep them in memory); a cached ciphertext is answered with one
+// decryption, and keys recovered before are tried on new ciphertexts first
+
 int cs642StudentCleanUp(void);
 // This is a clean up function called at the end of the cryptanalysis of the
 // different ciphers. Use it if you need to release  memory you allocated in
 // cs642StudentInit() for instance.
+
+//
+// Scoring functions, exported for the benchmarks
+
+double cipherNGPSum(char *ciphertext, int *ngrams);
+// This sums the 4-gram log probabilities of a text and counts its 4-grams
+
+void checkDictionary(char *inputWord, int *dictMatches);
+// This counts a word in dictMatches if it is in the dictionary
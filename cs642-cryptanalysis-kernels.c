@@ -0,0 +1,380 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-kernels.c
+//  Description    : This is the implementation of the decryption kernels used
+//                   inside the cryptanalysis search loops. Every kernel maps
+//                   normalized letters through a small lookup table so the
+//                   per-character work is a single load without branches.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-17-2026
+//
+
+// Include Files
+#include <string.h>
+// the AVX2 kernel extracts 64-bit lanes, which 32-bit x86 does not have
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define KERNELS_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define KERNELS_NEON 1
+#endif
+
+// Project Include Files
+#include "cs642-cryptanalysis-kernels.h"
+
+//
+// Defines
+
+#define HIST_FLUSH 255 // vector blocks before the 8-bit counters can overflow
+#define HIST_GROUP 8   // letters counted per pass over a block
+
+// histogram kernel signature, selected at runtime by initKernels
+typedef void (*HistogramKernel)(const uint8_t *buf, int len, uint8_t base,
+                                uint32_t *counts);
+
+//
+// Functions
+
+// count the few bytes left over after the vector blocks
+static inline void histogramTail(const uint8_t *buf, int len, uint8_t base,
+                                 uint32_t *counts) {
+  unsigned int c;
+  for (int i = 0; i < len; i++) {
+    c = (uint8_t)(buf[i] - base);
+    if (c < KERNEL_NALPHA) counts[c]++;
+  }
+}
+
+// count letters four bytes at a time into separate tables to avoid
+// store-to-load stalls on repeated letters
+static void histogramScalar(const uint8_t *buf, int len, uint8_t base,
+                            uint32_t *counts) {
+  int i, c;
+  uint32_t sub[4][256];
+
+  memset(sub, 0, sizeof(sub));
+  for (i = 0; i + 4 <= len; i += 4) {
+    sub[0][buf[i]]++;
+    sub[1][buf[i + 1]]++;
+    sub[2][buf[i + 2]]++;
+    sub[3][buf[i + 3]]++;
+  }
+  for (; i < len; i++) {
+    sub[0][buf[i]]++;
+  }
+  for (c = 0; c < KERNEL_NALPHA; c++) {
+    counts[c] += sub[0][(uint8_t)(base + c)] + sub[1][(uint8_t)(base + c)] +
+                 sub[2][(uint8_t)(base + c)] + sub[3][(uint8_t)(base + c)];
+  }
+}
+
+// The vector kernels compare each block of bytes against a group of
+// HIST_GROUP letters at a time, so the counters and the broadcast letters stay
+// in registers. Matches are summed in 8-bit lanes over at most HIST_FLUSH
+// vectors (small enough to stay in L1 across the groups) and then flushed.
+
+#ifdef KERNELS_X86
+// count a group of letters over nv 32-byte vectors
+__attribute__((target("avx2")))
+static inline void groupAVX2(const uint8_t *buf, int nv, uint8_t first,
+                             uint32_t *counts, int n) {
+  int c, blk;
+  __m256i acc[HIST_GROUP], key[HIST_GROUP], v, s;
+  const __m256i zero = _mm256_setzero_si256();
+
+  _Pragma("GCC unroll 8") for (c = 0; c < HIST_GROUP; c++) {
+    acc[c] = zero;
+    key[c] = _mm256_set1_epi8((char)(first + c));
+  }
+  for (blk = 0; blk < nv; blk++) {
+    v = _mm256_loadu_si256((const __m256i *)(buf + 32 * blk));
+    _Pragma("GCC unroll 8") for (c = 0; c < HIST_GROUP; c++) {
+      acc[c] = _mm256_sub_epi8(acc[c], _mm256_cmpeq_epi8(v, key[c]));
+    }
+  }
+  for (c = 0; c < n; c++) {
+    s = _mm256_sad_epu8(acc[c], zero);
+    counts[c] += _mm256_extract_epi64(s, 0) + _mm256_extract_epi64(s, 1) +
+                 _mm256_extract_epi64(s, 2) + _mm256_extract_epi64(s, 3);
+  }
+}
+
+__attribute__((target("avx2")))
+static void histogramAVX2(const uint8_t *buf, int len, uint8_t base,
+                          uint32_t *counts) {
+  int i = 0, g, nv;
+
+  while ((nv = (len - i) / 32) > 0) {
+    if (nv > HIST_FLUSH) nv = HIST_FLUSH;
+    for (g = 0; g < KERNEL_NALPHA; g += HIST_GROUP) {
+      groupAVX2(buf + i, nv, base + g, counts + g,
+                KERNEL_NALPHA - g < HIST_GROUP ? KERNEL_NALPHA - g : HIST_GROUP);
+    }
+    i += 32 * nv;
+  }
+  histogramTail(buf + i, len - i, base, counts);
+}
+#endif
+
+#ifdef KERNELS_NEON
+// count a group of letters over nv 16-byte vectors
+static inline void groupNEON(const uint8_t *buf, int nv, uint8_t first,
+                             uint32_t *counts, int n) {
+  int c, blk;
+  uint8x16_t acc[HIST_GROUP], key[HIST_GROUP], v;
+
+  _Pragma("GCC unroll 8") for (c = 0; c < HIST_GROUP; c++) {
+    acc[c] = vdupq_n_u8(0);
+    key[c] = vdupq_n_u8((uint8_t)(first + c));
+  }
+  for (blk = 0; blk < nv; blk++) {
+    v = vld1q_u8(buf + 16 * blk);
+    _Pragma("GCC unroll 8") for (c = 0; c < HIST_GROUP; c++) {
+      acc[c] = vsubq_u8(acc[c], vceqq_u8(v, key[c]));
+    }
+  }
+  for (c = 0; c < n; c++) {
+    counts[c] += vaddlvq_u8(acc[c]);
+  }
+}
+
+static void histogramNEON(const uint8_t *buf, int len, uint8_t base,
+                          uint32_t *counts) {
+  int i = 0, g, nv;
+
+  while ((nv = (len - i) / 16) > 0) {
+    if (nv > HIST_FLUSH) nv = HIST_FLUSH;
+    for (g = 0; g < KERNEL_NALPHA; g += HIST_GROUP) {
+      groupNEON(buf + i, nv, base + g, counts + g,
+                KERNEL_NALPHA - g < HIST_GROUP ? KERNEL_NALPHA - g : HIST_GROUP);
+    }
+    i += 16 * nv;
+  }
+  histogramTail(buf + i, len - i, base, counts);
+}
+#endif
+
+static HistogramKernel histogramKernel = histogramScalar;
+static const char *histogramKernelName = "scalar";
+
+// shift a letter index left by k (0-25), wrapping without a branch
+static inline uint8_t shiftLetter(int c, int k) {
+  int d = c - k;
+  return (uint8_t)(d + (KERNEL_NALPHA & (d >> 31)));
+}
+
+// fill a lookup table decrypting letter indexes rotated by shift
+static void fillShiftTable(char *lut, int shift) {
+  int c;
+  for (c = 0; c < KERNEL_NALPHA; c++) {
+    lut[c] = 'A' + shiftLetter(c, shift);
+  }
+  for (; c < KERNEL_LUT_SIZE; c++) {
+    lut[c] = ' ';
+  }
+}
+
+// map every normalized letter through a lookup table, unrolled by 4
+static void mapLetters(const uint8_t *letters, int len, const char *lut, char *out) {
+  int i;
+
+  for (i = 0; i + 4 <= len; i += 4) {
+    out[i] = lut[letters[i]];
+    out[i + 1] = lut[letters[i + 1]];
+    out[i + 2] = lut[letters[i + 2]];
+    out[i + 3] = lut[letters[i + 3]];
+  }
+  for (; i < len; i++) {
+    out[i] = lut[letters[i]];
+  }
+  out[len] = '\0';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : normalizeLetters
+// Description  : Map a text to letter indexes for the kernels
+//
+// Inputs       : text - the text to normalize
+//                len - the length of the text
+//                letters - the place to put len letter indexes
+// Outputs      : none
+
+void normalizeLetters(const char *text, int len, uint8_t *letters) {
+  int i;
+  unsigned int c;
+
+  for (i = 0; i < len; i++) {
+    c = (unsigned char)text[i] - 'A';
+    letters[i] = c < KERNEL_NALPHA ? (uint8_t)c : LETTER_SPACE;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : decryptROTXLetters
+// Description  : Decrypt normalized ROT-X ciphertext
+//
+// Inputs       : letters - the normalized ciphertext
+//                len - the number of letters
+//                shift - the rotation (0-25)
+//                out - the place to put the plaintext (len + 1 bytes)
+// Outputs      : none
+
+void decryptROTXLetters(const uint8_t *letters, int len, int shift, char *out) {
+  char lut[KERNEL_LUT_SIZE];
+
+  fillShiftTable(lut, shift);
+  mapLetters(letters, len, lut, out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : decryptVIGELetters
+// Description  : Decrypt normalized Vigenere ciphertext, each key position
+//                has its own rotation table and spaces still advance the key
+//
+// Inputs       : letters - the normalized ciphertext
+//                len - the number of letters
+//                key - the key letters ('A' rotates 0)
+//                keylen - the length of the key
+//                out - the place to put the plaintext (len + 1 bytes)
+// Outputs      : none
+
+void decryptVIGELetters(const uint8_t *letters, int len, const char *key,
+                        int keylen, char *out) {
+  int i, k, col = 0;
+  char luts[keylen][KERNEL_LUT_SIZE];
+
+  for (k = 0; k < keylen; k++) {
+    fillShiftTable(luts[k], key[k] - 'A');
+  }
+  for (i = 0; i < len; i++) {
+    out[i] = luts[col][letters[i]];
+    col++;
+    col &= -(col < keylen);
+  }
+  out[len] = '\0';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : decryptSUBSLetters
+// Description  : Decrypt normalized substitution ciphertext
+//
+// Inputs       : letters - the normalized ciphertext
+//                len - the number of letters
+//                key - the key, key[p] is the cipher letter for plaintext p
+//                out - the place to put the plaintext (len + 1 bytes)
+// Outputs      : none
+
+void decryptSUBSLetters(const uint8_t *letters, int len, const char *key,
+                        char *out) {
+  int c;
+  char lut[KERNEL_LUT_SIZE];
+
+  // invert the key into a table from cipher letter to plaintext
+  memset(lut, ' ', KERNEL_LUT_SIZE);
+  for (c = 0; c < KERNEL_NALPHA; c++) {
+    lut[(key[c] - 'A') & (KERNEL_LUT_SIZE - 1)] = 'A' + c;
+  }
+  mapLetters(letters, len, lut, out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : initKernels
+// Description  : Select the fastest histogram kernel the CPU supports, the
+//                scalar kernel is used until this is called
+//
+// Inputs       : none
+// Outputs      : none
+
+void initKernels(void) {
+#if defined(KERNELS_X86)
+  __builtin_cpu_init();
+  // a 16-byte SSE2 version of the vector kernel is slower than the 4-way
+  // scalar kernel, so without AVX2 the scalar kernel is kept
+  if (__builtin_cpu_supports("avx2")) {
+    histogramKernel = histogramAVX2;
+    histogramKernelName = "avx2";
+  }
+#elif defined(KERNELS_NEON)
+  histogramKernel = histogramNEON;
+  histogramKernelName = "neon";
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : kernelsName
+// Description  : Get the name of the selected histogram kernel
+//
+// Inputs       : none
+// Outputs      : the kernel name
+
+const char *kernelsName(void) {
+  return histogramKernelName;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : letterHistogram
+// Description  : Count the letters of a buffer
+//
+// Inputs       : buf - the bytes to count
+//                len - the number of bytes
+//                base - the byte value of letter 0 ('A' or 0)
+//                counts - the place to put the 26 letter counts
+// Outputs      : none
+
+void letterHistogram(const uint8_t *buf, int len, uint8_t base,
+                     uint32_t counts[KERNEL_NALPHA]) {
+  memset(counts, 0, KERNEL_NALPHA * sizeof(uint32_t));
+  histogramKernel(buf, len, base, counts);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : chiSquaredShifts
+// Description  : Compute the chi-squared statistic of a text decrypted with
+//                every possible shift from the histogram of its ciphertext.
+//                Decrypting with shift k turns cipher letter p + k into p, so
+//                the plaintext histogram is the cipher histogram rotated by k.
+//
+// Inputs       : counts - the cipher letter histogram
+//                expected - the expected plaintext letter probabilities
+//                chi - the place to put the statistic for each shift
+// Outputs      : none
+
+void chiSquaredShifts(const uint32_t counts[KERNEL_NALPHA],
+                      const double expected[KERNEL_NALPHA],
+                      double chi[KERNEL_NALPHA]) {
+  int k, p;
+  double n = 0, d, total;
+  double rotated[2 * KERNEL_NALPHA], e[KERNEL_NALPHA], inv[KERNEL_NALPHA];
+
+  // lay the histogram out twice so each rotation is a contiguous window
+  for (p = 0; p < KERNEL_NALPHA; p++) {
+    rotated[p] = rotated[p + KERNEL_NALPHA] = counts[p];
+    n += counts[p];
+  }
+
+  // the expected counts and their reciprocals are the same for every shift,
+  // so the inner loop has no division or branch, letters never expected
+  // count for nothing
+  for (p = 0; p < KERNEL_NALPHA; p++) {
+    e[p] = expected[p] * n;
+    inv[p] = e[p] > 0 ? 1 / e[p] : 0;
+  }
+  for (k = 0; k < KERNEL_NALPHA; k++) {
+    total = 0;
+    for (p = 0; p < KERNEL_NALPHA; p++) {
+      d = rotated[p + k] - e[p];
+      total += d * d * inv[p];
+    }
+    chi[k] = total;
+  }
+}
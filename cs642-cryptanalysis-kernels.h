@@ -0,0 +1,62 @@
+#ifndef CS642_CRYPTANALYSIS_KERNELS_INCLUDED
+#define CS642_CRYPTANALYSIS_KERNELS_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-kernels.h
+//  Description    : This is an include file to define the decryption kernels
+//                   used inside the cryptanalysis search loops. The kernels
+//                   work on text normalized to one letter index (0-25) per
+//                   byte, with every other character mapped to LETTER_SPACE.
+//
+//                   Letter histograms are vectorized (AVX2 on x86_64, NEON on
+//                   aarch64) and dispatched at runtime.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-17-2026
+
+// Include Files
+#include <stdint.h>
+
+//
+// Defines
+
+#define KERNEL_NALPHA 26
+#define LETTER_SPACE 26   // normalized value of a non-letter (space)
+#define KERNEL_LUT_SIZE 32 // lookup table stride, one entry per normalized value
+
+//
+// Kernel functions
+
+void initKernels(void);
+// Select the fastest histogram kernel the CPU supports
+
+const char *kernelsName(void);
+// Get the name of the selected histogram kernel
+
+void letterHistogram(const uint8_t *buf, int len, uint8_t base,
+                     uint32_t counts[KERNEL_NALPHA]);
+// Count the bytes equal to base + c for every letter c, use base 'A' for text
+// and 0 for normalized letters
+
+void chiSquaredShifts(const uint32_t counts[KERNEL_NALPHA],
+                      const double expected[KERNEL_NALPHA],
+                      double chi[KERNEL_NALPHA]);
+// Chi-squared of the text decrypted with every shift k against the expected
+// letter probabilities, computed by rotating a single histogram
+
+void normalizeLetters(const char *text, int len, uint8_t *letters);
+// Map a text to letter indexes, 'A'-'Z' to 0-25 and anything else to LETTER_SPACE
+
+void decryptROTXLetters(const uint8_t *letters, int len, int shift, char *out);
+// Decrypt normalized ROT-X ciphertext, rotating each letter left by shift
+
+void decryptVIGELetters(const uint8_t *letters, int len, const char *key,
+                        int keylen, char *out);
+// Decrypt normalized Vigenere ciphertext, spaces count as key positions
+
+void decryptSUBSLetters(const uint8_t *letters, int len, const char *key,
+                        char *out);
+// Decrypt normalized substitution ciphertext through an inverse key table
+
+#endif
@@ -0,0 +1,522 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-model.c
+//  Description    : This is the language model of the cryptanalysis project.
+//                   A model is one buffer laid out exactly like its file, a
+//                   header then the 1- to 4-gram log-probability tables and
+//                   an int16 fixed-point copy of the 4-grams, so building,
+//                   writing and mapping all share the same view.
+//                   Models are counted from text corpora streamed in chunks,
+//                   or from the dictionary words when there is no model file.
+//                   The analyzers share one model per process, loaded on
+//                   first use and freed when its last reference is dropped.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <compsci642_log.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-model.h"
+
+//
+// Defines
+
+#define MODEL_ALIGN 64             // tables start on cache line boundaries
+#define MODEL_FLOOR_COUNT 0.01     // count given to unseen n-grams
+#define CORPUS_CHUNK (1 << 16)     // bytes of corpus read at a time
+#define FIXED_MAX_SCALE (1 << 14)  // finest fixed-point step, 2^-14
+#define FNV64_OFFSET 0xcbf29ce484222325ULL
+#define FNV64_PRIME 0x100000001b3ULL
+
+//
+// Type definitions
+
+// the last symbols of a text being counted, as one base 27 number
+typedef struct gramstream {
+  size_t window;              // the last CS642_MODEL_MAX_GRAM symbols
+  int length;                 // symbols in the window
+  int last;                   // the last symbol, -1 at the start
+} GramStream;
+
+//
+// Global Data
+
+// the model shared by the analyzers of the process, the lock guards its
+// loading and its last release, taking more references needs no lock
+static cs642Model *sharedModel = NULL;
+static pthread_mutex_t sharedModelLock = PTHREAD_MUTEX_INITIALIZER;
+
+//
+// Functions
+
+// get the number of entries of the n-gram table
+static size_t tableEntries(int n) {
+  size_t entries = 1;
+  while (n-- > 0) entries *= CS642_MODEL_NSYMBOLS;
+  return entries;
+}
+
+// round a size up to the table alignment
+static size_t alignModel(size_t size) {
+  return (size + MODEL_ALIGN - 1) & ~(size_t)(MODEL_ALIGN - 1);
+}
+
+// FNV-1a hash of the bytes after the header, folded in a 64-bit word at a
+// time (the tables are padded to MODEL_ALIGN) to keep mapping fast
+static uint64_t modelChecksum(const void *base, size_t size) {
+  const uint8_t *p = (const uint8_t *)base + sizeof(cs642ModelHeader);
+  const uint8_t *end = (const uint8_t *)base + size;
+  uint64_t h = FNV64_OFFSET, word;
+
+  for (; p + sizeof(word) <= end; p += sizeof(word)) {
+    memcpy(&word, p, sizeof(word));
+    h ^= word;
+    h *= FNV64_PRIME;
+  }
+  while (p < end) {
+    h ^= *p++;
+    h *= FNV64_PRIME;
+  }
+  return h;
+}
+
+// point the model at the tables of its buffer
+static void bindModel(cs642Model *model) {
+  const cs642ModelHeader *header = model->base;
+  int n;
+
+  for (n = 0; n < CS642_MODEL_MAX_GRAM; n++) {
+    model->logProbs[n] = (const float *)((const char *)model->base + header->offsets[n]);
+    model->floors[n] = header->floors[n];
+  }
+  model->fixedLogProbs = (const int16_t *)((const char *)model->base + header->fixedOffset);
+  model->fixedUnit = header->fixedUnit;
+  model->flags = header->flags;
+}
+
+// check that a buffer holds a model this build can read, returns a reason
+// for the first problem found or NULL if it is valid
+static const char *checkModel(const void *base, size_t size) {
+  const cs642ModelHeader *header = base;
+  int n;
+
+  if (size < sizeof(cs642ModelHeader) ||
+      memcmp(header->magic, CS642_MODEL_MAGIC, sizeof(header->magic)) != 0)
+    return "not a model file";
+  if (header->version != CS642_MODEL_VERSION)
+    return "unsupported version";
+  if (header->headerSize != sizeof(cs642ModelHeader) ||
+      header->symbols != CS642_MODEL_NSYMBOLS || header->fileSize != size)
+    return "bad header";
+  for (n = 0; n < CS642_MODEL_MAX_GRAM; n++) {
+    if (header->offsets[n] % MODEL_ALIGN != 0 || header->offsets[n] > size ||
+        tableEntries(n + 1) * sizeof(float) > size - header->offsets[n])
+      return "bad table offset";
+  }
+  if (header->fixedOffset % MODEL_ALIGN != 0 || header->fixedOffset > size ||
+      tableEntries(CS642_MODEL_MAX_GRAM) * sizeof(int16_t) > size - header->fixedOffset ||
+      !(header->fixedUnit > 0))
+    return "bad fixed-point table";
+  if (modelChecksum(base, size) != header->checksum)
+    return "checksum mismatch";
+  return NULL;
+}
+
+// lay out an empty model, the header then the tables one after the other
+static int layoutModel(cs642Model *model, uint32_t flags) {
+  cs642ModelHeader *header;
+  size_t size;
+  int n;
+
+  memset(model, 0, sizeof(cs642Model));
+  size = alignModel(sizeof(cs642ModelHeader));
+  for (n = 0; n < CS642_MODEL_MAX_GRAM; n++) {
+    size += alignModel(tableEntries(n + 1) * sizeof(float));
+  }
+  size += alignModel(tableEntries(CS642_MODEL_MAX_GRAM) * sizeof(int16_t));
+  if ((model->base = calloc(1, size)) == NULL) return (-1);
+  model->size = size;
+  header = model->base;
+  memcpy(header->magic, CS642_MODEL_MAGIC, sizeof(header->magic));
+  header->version = CS642_MODEL_VERSION;
+  header->headerSize = sizeof(cs642ModelHeader);
+  header->symbols = CS642_MODEL_NSYMBOLS;
+  header->flags = flags;
+  header->fileSize = size;
+  header->offsets[0] = alignModel(sizeof(cs642ModelHeader));
+  for (n = 1; n < CS642_MODEL_MAX_GRAM; n++) {
+    header->offsets[n] = header->offsets[n - 1] + alignModel(tableEntries(n) * sizeof(float));
+  }
+  header->fixedOffset = header->offsets[CS642_MODEL_MAX_GRAM - 1] +
+                        alignModel(tableEntries(CS642_MODEL_MAX_GRAM) * sizeof(float));
+  return (0);
+}
+
+// allocate the n-gram count tables, their size is fixed by the alphabet
+// whatever the size of the text counted
+static int allocCounts(double *counts[CS642_MODEL_MAX_GRAM]) {
+  int n, r = 0;
+
+  for (n = 0; n < CS642_MODEL_MAX_GRAM; n++) {
+    counts[n] = calloc(tableEntries(n + 1), sizeof(double));
+    if (counts[n] == NULL) r = -1;
+  }
+  return r;
+}
+
+// release the n-gram count tables
+static void freeCounts(double *counts[CS642_MODEL_MAX_GRAM]) {
+  int n;
+
+  for (n = 0; n < CS642_MODEL_MAX_GRAM; n++) {
+    free(counts[n]);
+    counts[n] = NULL;
+  }
+}
+
+// start a gram stream, after a word separator if the grams cross words
+static void startGramStream(GramStream *stream, int afterSpace) {
+  stream->window = afterSpace ? CS642_MODEL_SPACE : 0;
+  stream->length = afterSpace ? 1 : 0;
+  stream->last = afterSpace ? CS642_MODEL_SPACE : -1;
+}
+
+// count every n-gram ending at the next symbol of a stream
+static void countSymbol(double *counts[CS642_MODEL_MAX_GRAM], GramStream *stream,
+                        int symbol, double weight) {
+  int n;
+  size_t span = CS642_MODEL_NSYMBOLS;
+
+  // a run of non-letters is a single separator
+  if (symbol == CS642_MODEL_SPACE && stream->last == CS642_MODEL_SPACE) return;
+  stream->last = symbol;
+  stream->window = (stream->window * CS642_MODEL_NSYMBOLS + symbol) %
+                   tableEntries(CS642_MODEL_MAX_GRAM);
+  if (stream->length < CS642_MODEL_MAX_GRAM) stream->length++;
+  for (n = 0; n < stream->length; n++, span *= CS642_MODEL_NSYMBOLS) {
+    counts[n][stream->window % span] += weight;
+  }
+}
+
+// quantize the 4-gram log probabilities to int16, with the finest power of
+// two step that still fits the floor so sums of steps are exact in a double
+static void quantizeModel(cs642Model *model) {
+  cs642ModelHeader *header = model->base;
+  const int n = CS642_MODEL_MAX_GRAM - 1;
+  const float *logProbs = (const float *)((char *)model->base + header->offsets[n]);
+  int16_t *table = (int16_t *)((char *)model->base + header->fixedOffset);
+  size_t i, entries = tableEntries(CS642_MODEL_MAX_GRAM);
+  float scale = 1, floor = header->floors[n];
+
+  while (scale < FIXED_MAX_SCALE && -floor * scale * 2 <= INT16_MAX) scale *= 2;
+  for (i = 0; i < entries; i++) {
+    table[i] = (int16_t)lrintf(fmaxf(logProbs[i], floor) * scale);
+  }
+  header->fixedUnit = 1 / scale;
+}
+
+// turn the counts into the log-probability tables of the model, with a
+// floor for unseen n-grams, and seal it with its checksum
+static void finishModel(cs642Model *model, double *counts[CS642_MODEL_MAX_GRAM]) {
+  cs642ModelHeader *header = model->base;
+  float *table;
+  double total;
+  size_t i, entries;
+  int n;
+
+  for (n = 0; n < CS642_MODEL_MAX_GRAM; n++) {
+    table = (float *)((char *)model->base + header->offsets[n]);
+    entries = tableEntries(n + 1);
+    total = 0;
+    for (i = 0; i < entries; i++) {
+      total += counts[n][i];
+    }
+    if (total == 0) total = 1;
+    header->floors[n] = log(MODEL_FLOOR_COUNT / total);
+    for (i = 0; i < entries; i++) {
+      table[i] = counts[n][i] > 0 ? log(counts[n][i] / total) : header->floors[n];
+    }
+  }
+  quantizeModel(model);
+  header->checksum = modelChecksum(model->base, model->size);
+  bindModel(model);
+}
+
+// get the model symbol of a character, every non-letter separates words
+static inline int modelSymbol(unsigned char ch) {
+  if (ch >= 'A' && ch <= 'Z') return ch - 'A';
+  if (ch >= 'a' && ch <= 'z') return ch - 'a';
+  return CS642_MODEL_SPACE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642BuildModel
+// Description  : Count the n-grams inside the dictionary words, weighting each
+//                word by its corpus count, into a model. Word order is lost
+//                in the dictionary, so no n-gram crosses a word boundary.
+//
+// Inputs       : model - the place to put the model
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642BuildModel(cs642Model *model) {
+  double *counts[CS642_MODEL_MAX_GRAM];
+  GramStream stream;
+  int i, j, dictSize = cs642GetDictSize();
+
+  if (allocCounts(counts) || layoutModel(model, 0)) {
+    freeCounts(counts);
+    cs642FreeModel(model);
+    return (-1);
+  }
+  for (i = 0; i < dictSize; i++) {
+    struct DictWord dictword = cs642GetWordfromDict(i);
+    startGramStream(&stream, 0);
+    for (j = 0; dictword.word[j]; j++) {
+      countSymbol(counts, &stream, modelSymbol(dictword.word[j]), dictword.count);
+    }
+  }
+  finishModel(model, counts);
+  freeCounts(counts);
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642BuildCorpusModel
+// Description  : Stream text corpora through a fixed-size chunk buffer,
+//                normalizing them to A-Z with every run of other characters
+//                as one space, and count every n-gram, word boundaries
+//                included, into a model. Memory stays bounded by the count
+//                tables whatever the size of the corpora.
+//
+// Inputs       : model - the place to put the model
+//                paths - the corpus files, - for stdin
+//                npaths - the number of corpus files
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642BuildCorpusModel(cs642Model *model, char *paths[], int npaths) {
+  double *counts[CS642_MODEL_MAX_GRAM];
+  unsigned char *chunk;
+  GramStream stream;
+  FILE *in;
+  size_t i, len, total = 0;
+  int f, r = 0;
+
+  chunk = malloc(CORPUS_CHUNK);
+  if (chunk == NULL || allocCounts(counts) || layoutModel(model, CS642_MODEL_WORD_GRAMS)) {
+    free(chunk);
+    freeCounts(counts);
+    cs642FreeModel(model);
+    return (-1);
+  }
+
+  for (f = 0; f < npaths && r == 0; f++) {
+    in = strcmp(paths[f], "-") ? fopen(paths[f], "rb") : stdin;
+    if (in == NULL) {
+      logMessage(LOG_ERROR_LEVEL, "Cannot open corpus (%s): %s", paths[f], strerror(errno));
+      r = -1;
+      break;
+    }
+    // each corpus starts at a word boundary, grams carry across chunks
+    startGramStream(&stream, 1);
+    while ((len = fread(chunk, 1, CORPUS_CHUNK, in)) > 0) {
+      for (i = 0; i < len; i++) {
+        countSymbol(counts, &stream, modelSymbol(chunk[i]), 1);
+      }
+      total += len;
+    }
+    if (ferror(in)) {
+      logMessage(LOG_ERROR_LEVEL, "Cannot read corpus (%s): %s", paths[f], strerror(errno));
+      r = -1;
+    }
+    if (in != stdin) fclose(in);
+  }
+
+  if (r == 0) {
+    logMessage(LOG_INFO_LEVEL, "Counted %zu bytes of corpus.", total);
+    finishModel(model, counts);
+  } else {
+    cs642FreeModel(model);
+  }
+  free(chunk);
+  freeCounts(counts);
+  return (r);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642WriteModel
+// Description  : Write a model to a file, through a temporary file renamed
+//                over it so processes never map a partly written model
+//
+// Inputs       : model - the model to write
+//                path - the file to write it to
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642WriteModel(cs642Model *model, const char *path) {
+  char tmp[4096];
+  FILE *out;
+  int r;
+
+  if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) return (-1);
+  if ((out = fopen(tmp, "wb")) == NULL) {
+    logMessage(LOG_ERROR_LEVEL, "Cannot create model file (%s): %s", tmp, strerror(errno));
+    return (-1);
+  }
+  r = fwrite(model->base, 1, model->size, out) == model->size ? 0 : -1;
+  if (fclose(out) != 0) r = -1;
+  if (r == 0 && rename(tmp, path) != 0) r = -1;
+  if (r != 0) {
+    logMessage(LOG_ERROR_LEVEL, "Cannot write model file (%s): %s", path, strerror(errno));
+    unlink(tmp);
+  }
+  return (r);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642MapModel
+// Description  : Map a model file read-only and shared, so every process
+//                using the same file uses the same pages, after checking its
+//                magic, version, layout and checksum
+//
+// Inputs       : model - the place to put the model
+//                path - the model file
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642MapModel(cs642Model *model, const char *path) {
+  struct stat st;
+  const char *problem;
+  void *base;
+  int fd;
+
+  memset(model, 0, sizeof(cs642Model));
+  if ((fd = open(path, O_RDONLY)) < 0) {
+    logMessage(LOG_INFO_LEVEL, "Cannot open model file (%s): %s", path, strerror(errno));
+    return (-1);
+  }
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(cs642ModelHeader)) {
+    logMessage(LOG_WARNING_LEVEL, "Model file (%s) is too short, ignored.", path);
+    close(fd);
+    return (-1);
+  }
+  base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    logMessage(LOG_WARNING_LEVEL, "Cannot map model file (%s): %s", path, strerror(errno));
+    return (-1);
+  }
+  if ((problem = checkModel(base, st.st_size)) != NULL) {
+    logMessage(LOG_WARNING_LEVEL, "Model file (%s) ignored: %s.", path, problem);
+    munmap(base, st.st_size);
+    return (-1);
+  }
+
+  model->base = base;
+  model->size = st.st_size;
+  model->mapped = 1;
+  bindModel(model);
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642FreeModel
+// Description  : Unmap or free a model
+//
+// Inputs       : model - the model to release
+// Outputs      : none
+
+void cs642FreeModel(cs642Model *model) {
+  if (model->base != NULL) {
+    if (model->mapped) munmap(model->base, model->size);
+    else free(model->base);
+  }
+  memset(model, 0, sizeof(cs642Model));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642ShareModel
+// Description  : Get the language model of the process and take a reference
+//                to it. The first call maps the model file, or counts the
+//                dictionary if the file is missing or invalid; later calls
+//                share that model, so there is at most one per process.
+//
+// Inputs       : path - the model file
+// Outputs      : the model, or NULL if failure
+
+const cs642Model *cs642ShareModel(const char *path) {
+  cs642Model *model;
+
+  pthread_mutex_lock(&sharedModelLock);
+  if ((model = sharedModel) != NULL) {
+    atomic_fetch_add(&model->refs, 1);
+  } else if ((model = malloc(sizeof(cs642Model))) != NULL) {
+    if (cs642MapModel(model, path) == 0) {
+      logMessage(LOG_INFO_LEVEL, "Mapped language model (%s).", path);
+    } else if (cs642BuildModel(model)) {
+      free(model);
+      model = NULL;
+    }
+    if (model != NULL) {
+      atomic_init(&model->refs, 1);
+      sharedModel = model;
+    }
+  }
+  pthread_mutex_unlock(&sharedModelLock);
+  return model;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642RetainModel
+// Description  : Take another reference to the shared model, the caller
+//                already holding one so the model cannot be freed meanwhile
+//
+// Inputs       : model - the shared model
+// Outputs      : the model
+
+const cs642Model *cs642RetainModel(const cs642Model *model) {
+  atomic_fetch_add(&((cs642Model *)model)->refs, 1);
+  return model;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642ReleaseModel
+// Description  : Drop a reference to the shared model, unmapping or freeing
+//                it once no reference is left
+//
+// Inputs       : model - the shared model, or NULL
+// Outputs      : none
+
+void cs642ReleaseModel(const cs642Model *model) {
+  cs642Model *shared = (cs642Model *)model;
+
+  if (shared == NULL) return;
+  // the last release happens under the lock, so cs642ShareModel never
+  // hands out a model that is being freed
+  pthread_mutex_lock(&sharedModelLock);
+  if (atomic_fetch_sub(&shared->refs, 1) == 1) {
+    if (sharedModel == shared) sharedModel = NULL;
+    cs642FreeModel(shared);
+    free(shared);
+  }
+  pthread_mutex_unlock(&sharedModelLock);
+}
@@ -0,0 +1,102 @@
+#ifndef CS642_CRYPTANALYSIS_MODEL_INCLUDED
+#define CS642_CRYPTANALYSIS_MODEL_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-model.h
+//  Description    : This is an include file to define the language model of
+//                   the cryptanalysis project: letter, bigram, trigram and
+//                   quadgram log-probability tables over A-Z and space. The
+//                   model is compiled offline from text corpora into a
+//                   versioned binary file (make model) that every process
+//                   maps read-only, so startup skips the counting and all
+//                   the processes of a host share one copy of the tables.
+//                   Within a process the analyzers share one immutable,
+//                   reference counted model that is read without locks.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+// Include Files
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Defines
+
+#define CS642_MODEL_FILE "cs642-model.bin" // Default model file
+#define CS642_MODEL_MAGIC "CS642LM"        // File magic, with its NUL
+#define CS642_MODEL_VERSION 3              // Bumped on any layout change
+#define CS642_MODEL_NSYMBOLS 27            // A-Z, then the word separator
+#define CS642_MODEL_SPACE 26               // Symbol of any run of non-letters
+#define CS642_MODEL_MAX_GRAM 4             // Tables for 1- to 4-grams
+
+// Header flags
+#define CS642_MODEL_WORD_GRAMS 0x1         // Counted across word boundaries,
+                                           // so n-grams with spaces are scored
+
+//
+// Type definitions
+
+// The file header, followed by the tables at the given offsets; every table
+// is indexed base 27 (a 3-gram abc at (a * 27 + b) * 27 + c) and holds floats,
+// except the int16 fixed-point copy of the 4-gram table
+typedef struct cs642ModelHeader {
+  char magic[8];                             // CS642_MODEL_MAGIC
+  uint32_t version;                          // CS642_MODEL_VERSION
+  uint32_t headerSize;                       // sizeof(cs642ModelHeader)
+  uint32_t symbols;                          // CS642_MODEL_NSYMBOLS
+  uint32_t flags;                            // CS642_MODEL_* flags
+  uint64_t fileSize;                         // Header and tables
+  uint64_t checksum;                         // FNV-1a of the bytes after the header
+  uint64_t offsets[CS642_MODEL_MAX_GRAM];    // File offset of each n-gram table
+  uint64_t fixedOffset;                      // File offset of the int16 4-grams
+  float floors[CS642_MODEL_MAX_GRAM];        // Log prob of an unseen n-gram
+  float fixedUnit;                           // Log prob of one int16 step
+} cs642ModelHeader;
+
+// A model, either mapped from its file or built in memory with the same layout
+typedef struct cs642Model {
+  void *base;                                // The header and tables
+  size_t size;
+  int mapped;                                // base is mmap'd, else malloc'd
+  const float *logProbs[CS642_MODEL_MAX_GRAM]; // logProbs[n - 1]: n-gram table
+  float floors[CS642_MODEL_MAX_GRAM];
+  uint32_t flags;
+  const int16_t *fixedLogProbs;              // 4-gram table in fixedUnit steps
+  float fixedUnit;
+  atomic_int refs;                           // References to a shared model
+} cs642Model;
+
+//
+// Model functions
+
+int cs642BuildModel(cs642Model *model);
+// Count the n-grams inside the dictionary words, weighted by their corpus
+// counts, into a model in memory
+
+int cs642BuildCorpusModel(cs642Model *model, char *paths[], int npaths);
+// Stream text corpora (- for stdin) in fixed-size chunks, counting every
+// n-gram of the text normalized to A-Z and single spaces into a model
+
+int cs642WriteModel(cs642Model *model, const char *path);
+// Write a model to its file
+
+int cs642MapModel(cs642Model *model, const char *path);
+// Map a model file read-only, checking its header and checksum
+
+void cs642FreeModel(cs642Model *model);
+// Unmap or free a model
+
+const cs642Model *cs642ShareModel(const char *path);
+// Get the model of the process, mapping its file or counting the dictionary
+// on first use, and take a reference to it; NULL if it cannot be loaded
+
+const cs642Model *cs642RetainModel(const cs642Model *model);
+// Take another reference to the shared model, which must already be held
+
+void cs642ReleaseModel(const cs642Model *model);
+// Drop a reference to the shared model, freeing it with the last one
+
+#endif
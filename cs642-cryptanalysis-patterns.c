@@ -0,0 +1,341 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-patterns.c
+//  Description    : This is the word-pattern solver of the cryptanalysis
+//                   project. The dictionary words are grouped once by letter
+//                   pattern, the most frequent first; a ciphertext's most
+//                   constrained words are then matched against their groups
+//                   by a depth-first search that keeps the letter mapping
+//                   one-to-one, and may skip a word that is not in the
+//                   dictionary, within a fixed node budget.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <compsci642_log.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-patterns.h"
+#include "cs642-cryptanalysis-stats.h"
+
+//
+// Defines
+
+#define NALPHA CS642_PATTERN_NALPHA
+#define PATTERN_MAX_LEN 24         // longer words are not indexed
+#define PATTERN_MIN_LEN 3          // shorter cipher words match too much
+#define PATTERN_SCAN_WORDS 256     // distinct cipher words considered
+#define PATTERN_MAX_WORDS 12       // most constrained cipher words searched
+#define PATTERN_MAX_CANDIDATES 64  // most frequent dictionary words per word
+#define PATTERN_MAX_NODES 20000    // candidate words tried per ciphertext
+#define PATTERN_LOAD_FACTOR 2
+
+//
+// Type definitions
+
+// a dictionary word and its letter pattern, grouped by pattern
+typedef struct patternword {
+  const char *word;
+  int len;
+  int count;
+  uint8_t pattern[PATTERN_MAX_LEN]; // order of first occurrence of each letter
+} PatternWord;
+
+// a slot of the pattern hash table, the words of a pattern are contiguous
+typedef struct patterngroup {
+  uint32_t hash;
+  int start;                  // first word of the group, -1 if the slot is free
+  int count;
+} PatternGroup;
+
+// the state of the search over the cipher words of one ciphertext
+typedef struct patternsolver {
+  const char *words[PATTERN_MAX_WORDS]; // cipher words, most constrained first
+  int lens[PATTERN_MAX_WORDS];
+  PatternGroup *groups[PATTERN_MAX_WORDS];
+  int remaining[PATTERN_MAX_WORDS + 1]; // letters in the words from i on
+  int nwords;
+  int8_t plainOf[NALPHA];     // cipher letter -> plain letter, -1 if free
+  int8_t cipherOf[NALPHA];    // plain letter -> cipher letter, -1 if free
+  int8_t bestPlainOf[NALPHA];
+  int matched;                // letters of the cipher words matched so far
+  int bestMatched;
+  long nodes;
+} PatternSolver;
+
+//
+// Global Data
+
+static PatternWord *patternWords = NULL;
+static int npatternWords = 0;
+static PatternGroup *patternTable = NULL;
+static uint32_t patternMask = 0;
+
+//
+// Functions
+
+// get the letter pattern of a word, each letter replaced by the order of its
+// first occurrence (ABCCA -> 0 1 2 2 0), -1 if it is not all A-Z or too long
+static int wordPattern(const char *word, int len, uint8_t *pattern) {
+  int8_t seen[NALPHA];
+  int i, c, next = 0;
+
+  if (len < 1 || len > PATTERN_MAX_LEN) return -1;
+  memset(seen, -1, sizeof(seen));
+  for (i = 0; i < len; i++) {
+    if (word[i] < 'A' || word[i] > 'Z') return -1;
+    c = word[i] - 'A';
+    if (seen[c] < 0) seen[c] = next++;
+    pattern[i] = seen[c];
+  }
+  return 0;
+}
+
+// FNV-1a hash of a pattern
+static uint32_t patternHash(const uint8_t *pattern, int len) {
+  uint32_t h = 2166136261u;
+  int i;
+
+  for (i = 0; i < len; i++) {
+    h ^= pattern[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// order words by pattern, then by word so duplicates are adjacent
+static int compareWordsByName(const void *a, const void *b) {
+  const PatternWord *x = a, *y = b;
+  int r;
+
+  if (x->len != y->len) return x->len - y->len;
+  if ((r = memcmp(x->pattern, y->pattern, x->len)) != 0) return r;
+  return strncmp(x->word, y->word, x->len);
+}
+
+// order words by pattern, then the most frequent first
+static int compareWordsByCount(const void *a, const void *b) {
+  const PatternWord *x = a, *y = b;
+  int r;
+
+  if (x->len != y->len) return x->len - y->len;
+  if ((r = memcmp(x->pattern, y->pattern, x->len)) != 0) return r;
+  if (x->count != y->count) return y->count - x->count;
+  return strncmp(x->word, y->word, x->len);
+}
+
+// find the group of dictionary words with a pattern, NULL if there is none
+static PatternGroup *findPattern(const uint8_t *pattern, int len) {
+  uint32_t slot, h = patternHash(pattern, len);
+  PatternWord *first;
+
+  for (slot = h & patternMask; patternTable[slot].start >= 0; slot = (slot + 1) & patternMask) {
+    first = &patternWords[patternTable[slot].start];
+    if (patternTable[slot].hash == h && first->len == len &&
+        memcmp(first->pattern, pattern, len) == 0)
+      return &patternTable[slot];
+  }
+  return NULL;
+}
+
+// map the letters of a cipher word to a candidate word, recording the new
+// cipher letters in assigned, returns how many or -1 on a conflict
+static int assignWord(PatternSolver *ps, const char *cipher, const char *plain,
+                      int len, int8_t *assigned) {
+  int i, c, p, n = 0;
+
+  for (i = 0; i < len; i++) {
+    c = cipher[i] - 'A';
+    p = plain[i] - 'A';
+    if (ps->plainOf[c] == p) continue;
+    if (ps->plainOf[c] >= 0 || ps->cipherOf[p] >= 0) {
+      // undo this word's mappings
+      while (n > 0) {
+        c = assigned[--n];
+        ps->cipherOf[ps->plainOf[c]] = -1;
+        ps->plainOf[c] = -1;
+      }
+      return -1;
+    }
+    ps->plainOf[c] = p;
+    ps->cipherOf[p] = c;
+    assigned[n++] = c;
+  }
+  return n;
+}
+
+// search the candidates of cipher word w on, keeping the mapping that matches
+// the most cipher word letters; a word may be skipped, as names and words
+// missing from the dictionary have no right candidate
+static void solveFrom(PatternSolver *ps, int w) {
+  PatternGroup *group;
+  int8_t assigned[PATTERN_MAX_LEN];
+  int i, n, ncand;
+
+  if (ps->matched > ps->bestMatched) {
+    ps->bestMatched = ps->matched;
+    memcpy(ps->bestPlainOf, ps->plainOf, sizeof(ps->plainOf));
+  }
+  if (w == ps->nwords || ps->nodes >= PATTERN_MAX_NODES ||
+      ps->matched + ps->remaining[w] <= ps->bestMatched)
+    return;
+
+  group = ps->groups[w];
+  ncand = group->count < PATTERN_MAX_CANDIDATES ? group->count : PATTERN_MAX_CANDIDATES;
+  for (i = 0; i < ncand && ps->nodes < PATTERN_MAX_NODES; i++) {
+    ps->nodes++;
+    n = assignWord(ps, ps->words[w], patternWords[group->start + i].word, ps->lens[w], assigned);
+    if (n < 0) continue;
+    ps->matched += ps->lens[w];
+    solveFrom(ps, w + 1);
+    ps->matched -= ps->lens[w];
+    while (n > 0) {
+      int c = assigned[--n];
+      ps->cipherOf[ps->plainOf[c]] = -1;
+      ps->plainOf[c] = -1;
+    }
+  }
+  solveFrom(ps, w + 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642BuildPatternIndex
+// Description  : Group the distinct dictionary words by letter pattern, the
+//                most frequent first, behind a hash table of the patterns
+//
+// Inputs       : void
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642BuildPatternIndex(void) {
+  int i, n = 0, dictSize = cs642GetDictSize();
+  uint32_t slot, size = 1;
+
+  patternWords = malloc((dictSize + 1) * sizeof(PatternWord));
+  if (patternWords == NULL) return (-1);
+  for (i = 0; i < dictSize; i++) {
+    DictWord dictWord = cs642GetWordfromDict(i);
+    patternWords[n].word = dictWord.word;
+    patternWords[n].len = strlen(dictWord.word);
+    patternWords[n].count = dictWord.count;
+    if (wordPattern(dictWord.word, patternWords[n].len, patternWords[n].pattern) == 0) n++;
+  }
+
+  // merge duplicate words, then put each pattern's most frequent words first
+  qsort(patternWords, n, sizeof(PatternWord), compareWordsByName);
+  for (i = 0, npatternWords = 0; i < n; i++) {
+    if (npatternWords > 0 && compareWordsByName(&patternWords[npatternWords - 1], &patternWords[i]) == 0)
+      patternWords[npatternWords - 1].count += patternWords[i].count;
+    else
+      patternWords[npatternWords++] = patternWords[i];
+  }
+  qsort(patternWords, npatternWords, sizeof(PatternWord), compareWordsByCount);
+
+  // hash each run of words sharing a pattern
+  while (size < (uint32_t)npatternWords * PATTERN_LOAD_FACTOR) size <<= 1;
+  patternTable = malloc(size * sizeof(PatternGroup));
+  if (patternTable == NULL) return (-1);
+  patternMask = size - 1;
+  for (slot = 0; slot < size; slot++) patternTable[slot].start = -1;
+  for (i = 0; i < npatternWords; i += n) {
+    PatternWord *first = &patternWords[i];
+    for (n = 1; i + n < npatternWords && first->len == patternWords[i + n].len &&
+                memcmp(first->pattern, patternWords[i + n].pattern, first->len) == 0; n++);
+    PatternGroup group = {patternHash(first->pattern, first->len), i, n};
+    for (slot = group.hash & patternMask; patternTable[slot].start >= 0; slot = (slot + 1) & patternMask);
+    patternTable[slot] = group;
+  }
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SolvePatterns
+// Description  : Recover part of a substitution key from the dictionary words
+//                that fit the letter patterns of the cipher words. The
+//                distinct cipher words with the fewest candidates, longest
+//                first on ties, are searched depth first in that order.
+//
+// Inputs       : text - the normalized ciphertext
+//                plainOf - the place to put the plain letter of each cipher
+//                          letter, -1 for the letters left unknown
+// Outputs      : the number of cipher letters mapped
+
+int cs642SolvePatterns(const cs642Text *text, int8_t plainOf[CS642_PATTERN_NALPHA]) {
+  PatternSolver ps;
+  const char *word, *seen[PATTERN_SCAN_WORDS];
+  int seenLens[PATTERN_SCAN_WORDS];
+  uint8_t pattern[PATTERN_MAX_LEN];
+  PatternGroup *group;
+  int i, j, n, nseen = 0, mapped = 0;
+  uint64_t start = cs642StatNow();
+
+  memset(&ps, 0, sizeof(ps));
+  memset(ps.plainOf, -1, sizeof(ps.plainOf));
+  memset(ps.cipherOf, -1, sizeof(ps.cipherOf));
+  memset(ps.bestPlainOf, -1, sizeof(ps.bestPlainOf));
+
+  // collect the distinct cipher words that have dictionary candidates,
+  // keeping the most constrained ones in insertion order
+  for (i = 0; i < text->nwords && nseen < PATTERN_SCAN_WORDS; i++) {
+    word = &text->canon[text->words[i].start];
+    n = text->words[i].len;
+    if (n < PATTERN_MIN_LEN || wordPattern(word, n, pattern)) continue;
+    for (j = 0; j < nseen && (seenLens[j] != n || strncmp(seen[j], word, n)); j++);
+    if (j < nseen) continue;
+    seen[nseen] = word;
+    seenLens[nseen++] = n;
+    if ((group = findPattern(pattern, n)) == NULL) continue;
+
+    // insert by candidate count, then longest first
+    for (j = ps.nwords; j > 0 && (ps.groups[j - 1]->count > group->count ||
+                                 (ps.groups[j - 1]->count == group->count && ps.lens[j - 1] < n)); j--) {
+      if (j < PATTERN_MAX_WORDS) {
+        ps.words[j] = ps.words[j - 1];
+        ps.lens[j] = ps.lens[j - 1];
+        ps.groups[j] = ps.groups[j - 1];
+      }
+    }
+    if (j < PATTERN_MAX_WORDS) {
+      ps.words[j] = word;
+      ps.lens[j] = n;
+      ps.groups[j] = group;
+      if (ps.nwords < PATTERN_MAX_WORDS) ps.nwords++;
+    }
+  }
+  for (i = ps.nwords - 1; i >= 0; i--) {
+    ps.remaining[i] = ps.remaining[i + 1] + ps.lens[i];
+  }
+
+  solveFrom(&ps, 0);
+  for (i = 0; i < NALPHA; i++) {
+    plainOf[i] = ps.bestPlainOf[i];
+    if (plainOf[i] >= 0) mapped++;
+  }
+  cs642StatTime(CS642_PHASE_PATTERNS, start);
+  logMessage(CipherVerboseLevel, "Pattern solver: %d words, %ld nodes, %d letters mapped.",
+             ps.nwords, ps.nodes, mapped);
+  return mapped;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642FreePatternIndex
+// Description  : Release the pattern index
+//
+// Inputs       : void
+// Outputs      : none
+
+void cs642FreePatternIndex(void) {
+  free(patternWords);
+  free(patternTable);
+  patternWords = NULL;
+  patternTable = NULL;
+  npatternWords = 0;
+  patternMask = 0;
+}
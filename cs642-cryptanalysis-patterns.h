@@ -0,0 +1,44 @@
+#ifndef CS642_CRYPTANALYSIS_PATTERNS_INCLUDED
+#define CS642_CRYPTANALYSIS_PATTERNS_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-patterns.h
+//  Description    : This is an include file to define the word-pattern index
+//                   of the dictionary and the solver that recovers part of a
+//                   substitution key from it. A substitution keeps the
+//                   repeated letters of a word in place, so a cipher word
+//                   like XQZZX (pattern ABCCA) can only be a dictionary word
+//                   with the same pattern, and long words with rare patterns
+//                   pin down several key letters at once.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+// Include Files
+#include <stdint.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-text.h"
+
+//
+// Defines
+
+#define CS642_PATTERN_NALPHA 26
+
+//
+// Pattern functions
+
+int cs642BuildPatternIndex(void);
+// Index the dictionary words by their letter pattern, 0 if successful
+
+int cs642SolvePatterns(const cs642Text *text, int8_t plainOf[CS642_PATTERN_NALPHA]);
+// Map the cipher letters of the most constrained cipher words to the
+// letters of consistent dictionary words, matching as many letters as a
+// bounded search finds; puts the plaintext letter of each cipher letter
+// (-1 if unknown) and returns the number of cipher letters mapped
+
+void cs642FreePatternIndex(void);
+// Release the pattern index
+
+#endif
@@ -0,0 +1,301 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-pool.c
+//  Description    : This is the work-stealing thread pool of the
+//                   cryptanalysis program. Tasks are dealt round robin onto
+//                   per-worker deques; a worker runs its own tasks oldest
+//                   first, so results complete roughly in submission order,
+//                   and once its deque is empty it steals the newest task of
+//                   another worker. A worker stuck on a long substitution
+//                   search therefore never holds back the ROT-X jobs queued
+//                   behind it.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-pool.h"
+
+//
+// Defines
+
+#define POOL_MAX_WORKERS 64
+#define POOL_DEQUE_SIZE 16 // initial slots of a deque, doubled when full
+
+//
+// Type definitions
+
+// a growable ring of queued tasks, the owner takes from the head and
+// thieves take from the tail
+typedef struct taskdeque {
+  pthread_mutex_t lock;
+  cs642Task **tasks;
+  int head;                   // slot of the oldest task
+  int count;
+  int size;
+} TaskDeque;
+
+// one worker thread and its deque
+typedef struct poolworker {
+  struct cs642Pool *pool;
+  int id;
+  pthread_t thread;
+  TaskDeque deque;
+} PoolWorker;
+
+struct cs642Pool {
+  int nworkers;
+  PoolWorker workers[POOL_MAX_WORKERS];
+  atomic_int queued;          // tasks in all deques, not yet taken
+  unsigned int nextWorker;    // deque the next submission goes to
+  int shutdown;
+  pthread_mutex_t lock;       // guards shutdown, task done flags and sleeps
+  pthread_cond_t workCond;    // signalled when a task is queued
+  pthread_cond_t doneCond;    // broadcast when a task has run
+};
+
+//
+// Functions
+
+// set up an empty deque
+static int initDeque(TaskDeque *deque) {
+  deque->tasks = malloc(POOL_DEQUE_SIZE * sizeof(cs642Task *));
+  if (deque->tasks == NULL) return -1;
+  deque->head = 0;
+  deque->count = 0;
+  deque->size = POOL_DEQUE_SIZE;
+  pthread_mutex_init(&deque->lock, NULL);
+  return 0;
+}
+
+// release a deque
+static void freeDeque(TaskDeque *deque) {
+  pthread_mutex_destroy(&deque->lock);
+  free(deque->tasks);
+  deque->tasks = NULL;
+}
+
+// append a task at the tail of a deque, growing it if it is full
+static int pushTask(TaskDeque *deque, cs642Task *task) {
+  cs642Task **grown;
+  int i;
+
+  pthread_mutex_lock(&deque->lock);
+  if (deque->count == deque->size) {
+    grown = malloc(2 * deque->size * sizeof(cs642Task *));
+    if (grown == NULL) {
+      pthread_mutex_unlock(&deque->lock);
+      return -1;
+    }
+    for (i = 0; i < deque->count; i++) {
+      grown[i] = deque->tasks[(deque->head + i) % deque->size];
+    }
+    free(deque->tasks);
+    deque->tasks = grown;
+    deque->head = 0;
+    deque->size *= 2;
+  }
+  deque->tasks[(deque->head + deque->count) % deque->size] = task;
+  deque->count++;
+  pthread_mutex_unlock(&deque->lock);
+  return 0;
+}
+
+// take the oldest task of a deque, NULL if it is empty
+static cs642Task *popTask(TaskDeque *deque) {
+  cs642Task *task = NULL;
+
+  pthread_mutex_lock(&deque->lock);
+  if (deque->count > 0) {
+    task = deque->tasks[deque->head];
+    deque->head = (deque->head + 1) % deque->size;
+    deque->count--;
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return task;
+}
+
+// take the newest task of a deque, NULL if it is empty
+static cs642Task *stealTask(TaskDeque *deque) {
+  cs642Task *task = NULL;
+
+  pthread_mutex_lock(&deque->lock);
+  if (deque->count > 0) {
+    deque->count--;
+    task = deque->tasks[(deque->head + deque->count) % deque->size];
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return task;
+}
+
+// find a task for a worker, its own first, then one stolen from the others
+static cs642Task *findTask(PoolWorker *worker) {
+  cs642Pool *pool = worker->pool;
+  cs642Task *task;
+  int i;
+
+  if (atomic_load(&pool->queued) == 0) return NULL;
+  task = popTask(&worker->deque);
+  for (i = 1; task == NULL && i < pool->nworkers; i++) {
+    task = stealTask(&pool->workers[(worker->id + i) % pool->nworkers].deque);
+  }
+  if (task != NULL) atomic_fetch_sub(&pool->queued, 1);
+  return task;
+}
+
+// the worker thread, runs tasks until the pool is shut down and drained
+static void *runWorker(void *arg) {
+  PoolWorker *worker = arg;
+  cs642Pool *pool = worker->pool;
+  cs642Task *task;
+
+  for (;;) {
+    if ((task = findTask(worker)) != NULL) {
+      task->run(task->arg);
+      pthread_mutex_lock(&pool->lock);
+      task->done = 1;
+      pthread_cond_broadcast(&pool->doneCond);
+      pthread_mutex_unlock(&pool->lock);
+      continue;
+    }
+
+    // sleep until a task is queued, queued is raised before the signal
+    pthread_mutex_lock(&pool->lock);
+    while (atomic_load(&pool->queued) == 0 && !pool->shutdown) {
+      pthread_cond_wait(&pool->workCond, &pool->lock);
+    }
+    if (atomic_load(&pool->queued) == 0 && pool->shutdown) {
+      pthread_mutex_unlock(&pool->lock);
+      return NULL;
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642CreatePool
+// Description  : Start a pool of worker threads, each with its own deque
+//
+// Inputs       : workers - the number of worker threads, 0 for one per CPU
+// Outputs      : the pool if successful, NULL if failure
+
+cs642Pool *cs642CreatePool(int workers) {
+  cs642Pool *pool;
+  long n = workers > 0 ? workers : sysconf(_SC_NPROCESSORS_ONLN);
+  int i;
+
+  if (n < 1) n = 1;
+  if (n > POOL_MAX_WORKERS) n = POOL_MAX_WORKERS;
+  pool = calloc(1, sizeof(cs642Pool));
+  if (pool == NULL) return NULL;
+  atomic_init(&pool->queued, 0);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->workCond, NULL);
+  pthread_cond_init(&pool->doneCond, NULL);
+
+  for (i = 0; i < n; i++) {
+    pool->workers[i].pool = pool;
+    pool->workers[i].id = i;
+    if (initDeque(&pool->workers[i].deque)) break;
+    if (pthread_create(&pool->workers[i].thread, NULL, runWorker,
+                       &pool->workers[i])) {
+      freeDeque(&pool->workers[i].deque);
+      break;
+    }
+    pool->nworkers++;
+  }
+  if (pool->nworkers == 0) {
+    cs642DestroyPool(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642PoolWorkers
+// Description  : Get the number of worker threads of a pool
+//
+// Inputs       : pool - the pool
+// Outputs      : the number of workers
+
+int cs642PoolWorkers(cs642Pool *pool) { return pool->nworkers; }
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642SubmitTask
+// Description  : Queue a task on the next worker's deque, round robin, and
+//                wake a sleeping worker to run or steal it
+//
+// Inputs       : pool - the pool
+//                task - the task, which must stay valid until it has run
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642SubmitTask(cs642Pool *pool, cs642Task *task) {
+  PoolWorker *worker = &pool->workers[pool->nextWorker++ % pool->nworkers];
+
+  // count the task first so a worker that takes it never sees queued < 0
+  task->done = 0;
+  atomic_fetch_add(&pool->queued, 1);
+  if (pushTask(&worker->deque, task)) {
+    atomic_fetch_sub(&pool->queued, 1);
+    return (-1);
+  }
+  pthread_mutex_lock(&pool->lock);
+  pthread_cond_signal(&pool->workCond);
+  pthread_mutex_unlock(&pool->lock);
+  return (0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642WaitTask
+// Description  : Wait until a submitted task has run, tasks waited on in
+//                submission order give results in submission order
+//
+// Inputs       : pool - the pool
+//                task - the task to wait for
+// Outputs      : none
+
+void cs642WaitTask(cs642Pool *pool, cs642Task *task) {
+  pthread_mutex_lock(&pool->lock);
+  while (!task->done) {
+    pthread_cond_wait(&pool->doneCond, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642DestroyPool
+// Description  : Let the workers drain their deques, join them and release
+//                the pool
+//
+// Inputs       : pool - the pool to destroy
+// Outputs      : none
+
+void cs642DestroyPool(cs642Pool *pool) {
+  int i;
+
+  if (pool == NULL) return;
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = 1;
+  pthread_cond_broadcast(&pool->workCond);
+  pthread_mutex_unlock(&pool->lock);
+  for (i = 0; i < pool->nworkers; i++) {
+    pthread_join(pool->workers[i].thread, NULL);
+    freeDeque(&pool->workers[i].deque);
+  }
+  pthread_cond_destroy(&pool->workCond);
+  pthread_cond_destroy(&pool->doneCond);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool);
+}
@@ -0,0 +1,49 @@
+#ifndef CS642_CRYPTANALYSIS_POOL_INCLUDED
+#define CS642_CRYPTANALYSIS_POOL_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-pool.h
+//  Description    : This is an include file to define the work-stealing
+//                   thread pool that analyzes independent ciphertexts
+//                   concurrently. Each worker owns a deque of tasks, and an
+//                   idle worker steals from the others, so cheap and
+//                   expensive analyses balance across the workers by
+//                   themselves.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+//
+// Type definitions
+
+// A unit of work, embedded by the caller in its own job structure and owned
+// by the caller until cs642WaitTask returns
+typedef struct cs642Task {
+  void (*run)(void *arg); // The function to run on a worker
+  void *arg;              // Its argument
+  int done;               // Set once run returns, guarded by the pool
+} cs642Task;
+
+// The pool itself is private to the pool module
+typedef struct cs642Pool cs642Pool;
+
+//
+// Pool functions
+
+cs642Pool *cs642CreatePool(int workers);
+// Start a pool of workers threads (0 for one per CPU), NULL if failure
+
+int cs642PoolWorkers(cs642Pool *pool);
+// Get the number of worker threads of a pool
+
+int cs642SubmitTask(cs642Pool *pool, cs642Task *task);
+// Queue a task on the next worker's deque, 0 if successful, -1 if failure
+
+void cs642WaitTask(cs642Pool *pool, cs642Task *task);
+// Wait until a submitted task has run
+
+void cs642DestroyPool(cs642Pool *pool);
+// Run every queued task, then stop the workers and release the pool
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef CS642_CRYPTANALYSIS_RANDOM_INCLUDED
+#define CS642_CRYPTANALYSIS_RANDOM_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-random.h
+//  Description    : This is an include file to define the pseudo-random
+//                   generator of the searches: xoshiro256** with its state in
+//                   a context the caller owns, so concurrent searches never
+//                   share one, seeded from a single 64-bit value through
+//                   splitmix64 so a logged seed replays a run. Bounded draws
+//                   use Lemire's multiply and reject method, which has no
+//                   modulo bias.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+// Include Files
+#include <stdint.h>
+
+//
+// Type definitions
+
+// The state of a generator
+typedef struct cs642Random {
+  uint64_t s[4];
+} cs642Random;
+
+//
+// Generator functions
+
+// Get the next splitmix64 output, advancing its state
+static inline uint64_t cs642SplitMix64(uint64_t *state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+// Seed a generator, any seed (even 0) gives a valid state
+static inline void cs642SeedRandom(cs642Random *rng, uint64_t seed) {
+  int i;
+  for (i = 0; i < 4; i++) rng->s[i] = cs642SplitMix64(&seed);
+}
+
+// Get the next 64 random bits (xoshiro256**)
+static inline uint64_t cs642Random64(cs642Random *rng) {
+  uint64_t *s = rng->s;
+  uint64_t result = s[1] * 5, t = s[1] << 17;
+
+  result = ((result << 7) | (result >> 57)) * 9;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+  return result;
+}
+
+// Get a uniform integer in [0, n), n > 0, without modulo bias
+static inline uint32_t cs642RandomBelow(cs642Random *rng, uint32_t n) {
+  uint64_t m = (cs642Random64(rng) >> 32) * n;
+  uint32_t threshold;
+
+  if ((uint32_t)m < n) {
+    threshold = -n % n;
+    while ((uint32_t)m < threshold) m = (cs642Random64(rng) >> 32) * n;
+  }
+  return (uint32_t)(m >> 32);
+}
+
+// Get a uniform double in [0, 1)
+static inline double cs642RandomUnit(cs642Random *rng) {
+  return (cs642Random64(rng) >> 11) * 0x1.0p-53;
+}
+
+// Get a uniform pair of distinct integers in [0, n), n > 1, in one draw each
+static inline void cs642RandomPair(cs642Random *rng, uint32_t n, int *a, int *b) {
+  *a = cs642RandomBelow(rng, n);
+  *b = cs642RandomBelow(rng, n - 1);
+  if (*b >= *a) (*b)++;
+}
+
+#endif
@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-stats.c
+//  Description    : This is the instrumentation of the cryptanalysis program.
+//                   The hot paths update plain thread-local counters, which
+//                   costs no more than the increment itself; the lock is only
+//                   taken to flush a thread's block into the totals.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <compsci642_log.h>
+#include <pthread.h>
+#include <string.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-stats.h"
+
+//
+// Global Data
+
+_Thread_local cs642Stats cs642ThreadStats;
+
+static cs642Stats statsTotals;
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *statsPhaseNames[] = {"key length", "histogram", "scoring",
+                                        "dictionary", "patterns"};
+
+//
+// Functions
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642FlushStats
+// Description  : Add the counters of the calling thread to the process totals
+//                and clear them, called when a search chain or batch record
+//                completes so no thread exits with unflushed counters
+//
+// Inputs       : void
+// Outputs      : none
+
+void cs642FlushStats(void) {
+  int i;
+
+  pthread_mutex_lock(&statsLock);
+  for (i = 0; i < CS642_PHASE_MAX; i++) {
+    statsTotals.calls[i] += cs642ThreadStats.calls[i];
+    statsTotals.ns[i] += cs642ThreadStats.ns[i];
+  }
+  for (i = 0; i < CS642_COUNT_MAX; i++) {
+    statsTotals.counts[i] += cs642ThreadStats.counts[i];
+  }
+  pthread_mutex_unlock(&statsLock);
+  memset(&cs642ThreadStats, 0, sizeof(cs642Stats));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642LogStats
+// Description  : Flush the calling thread and log the time of each phase and
+//                the event counts of the process
+//
+// Inputs       : level - the log level of the summary
+// Outputs      : none
+
+void cs642LogStats(uint32_t level) {
+  cs642Stats totals;
+  uint64_t *counts = totals.counts;
+  int i;
+
+  cs642FlushStats();
+  pthread_mutex_lock(&statsLock);
+  totals = statsTotals;
+  pthread_mutex_unlock(&statsLock);
+
+  for (i = 0; i < CS642_PHASE_MAX; i++) {
+    logMessage(level, "%-10s %10llu calls %12.3f ms %10.3f us/call", statsPhaseNames[i],
+               (unsigned long long)totals.calls[i], totals.ns[i] / 1e6,
+               totals.calls[i] ? totals.ns[i] / 1e3 / totals.calls[i] : 0.0);
+  }
+  logMessage(level, "swaps      %10llu scored, %llu accepted, %llu rejected",
+             (unsigned long long)counts[CS642_COUNT_SWAPS],
+             (unsigned long long)(counts[CS642_COUNT_SWAPS] - counts[CS642_COUNT_REJECTED]),
+             (unsigned long long)counts[CS642_COUNT_REJECTED]);
+  logMessage(level, "restarts   %10llu", (unsigned long long)counts[CS642_COUNT_RESTARTS]);
+  logMessage(level, "lookups    %10llu dictionary words",
+             (unsigned long long)counts[CS642_COUNT_DICT_WORDS]);
+}
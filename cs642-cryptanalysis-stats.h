@@ -0,0 +1,83 @@
+#ifndef CS642_CRYPTANALYSIS_STATS_INCLUDED
+#define CS642_CRYPTANALYSIS_STATS_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-stats.h
+//  Description    : This is an include file to define the instrumentation of
+//                   the cryptanalysis hot paths: per-thread phase timers and
+//                   event counters. Updates only touch the calling thread's
+//                   block, which is flushed into the process totals once per
+//                   search chain or batch record, and the totals are logged
+//                   as a summary under their own log level.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+// Include Files
+#include <stdint.h>
+#include <time.h>
+
+//
+// Type definitions
+
+// Timed phases of an analysis
+typedef enum {
+  CS642_PHASE_KEYLEN = 0,    // Vigenere key length ranking
+  CS642_PHASE_HISTOGRAM = 1, // Letter and column histograms
+  CS642_PHASE_SCORING = 2,   // Substitution search rounds, n-gram scoring
+  CS642_PHASE_DICT = 3,      // Dictionary checks
+  CS642_PHASE_PATTERNS = 4,  // Word-pattern key seeding
+  CS642_PHASE_MAX = 5
+} cs642StatPhase;
+
+// Counted events
+typedef enum {
+  CS642_COUNT_SWAPS = 0,     // Substitution key swaps scored
+  CS642_COUNT_REJECTED = 1,  // Swaps undone by the search
+  CS642_COUNT_RESTARTS = 2,  // Substitution search rounds
+  CS642_COUNT_DICT_WORDS = 3, // Words looked up in the dictionary
+  CS642_COUNT_MAX = 4
+} cs642StatCounter;
+
+// The counters of one thread, or the totals of the process
+typedef struct cs642Stats {
+  uint64_t calls[CS642_PHASE_MAX]; // Times each phase ran
+  uint64_t ns[CS642_PHASE_MAX];    // Time spent in each phase
+  uint64_t counts[CS642_COUNT_MAX];
+} cs642Stats;
+
+//
+// External declarations
+
+extern _Thread_local cs642Stats cs642ThreadStats;
+// The counters of the calling thread, not yet flushed
+
+//
+// Instrumentation functions
+
+// Get the start time of a phase, in ns
+static inline uint64_t cs642StatNow(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+// Charge the time since start to a phase of the calling thread
+static inline void cs642StatTime(cs642StatPhase phase, uint64_t start) {
+  cs642ThreadStats.calls[phase]++;
+  cs642ThreadStats.ns[phase] += cs642StatNow() - start;
+}
+
+// Count n events on the calling thread
+static inline void cs642StatCount(cs642StatCounter counter, uint64_t n) {
+  cs642ThreadStats.counts[counter] += n;
+}
+
+void cs642FlushStats(void);
+// Add the counters of the calling thread to the process totals and clear them
+
+void cs642LogStats(uint32_t level);
+// Flush the calling thread and log the process totals at a log level
+
+#endif
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-text.c
+//  Description    : This is the ciphertext front end of the cryptanalysis
+//                   program. A text is read once into its canonical form,
+//                   letter indexes, word table and the list of changed bytes;
+//                   the changes are undone on the plaintext at output.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+//
+
+// Include Files
+#include <stdlib.h>
+#include <string.h>
+
+// Project Include Files
+#include "cs642-cryptanalysis-kernels.h"
+#include "cs642-cryptanalysis-text.h"
+
+//
+// Defines
+
+#define TEXT_MIN_ENTRIES 64   // first allocation of the word and mark tables
+
+//
+// Functions
+
+// make room for one more entry of size bytes in a growing table, doubling it
+static int growTable(void **table, int used, int *capacity, size_t size) {
+  void *grown;
+
+  if (used < *capacity) return 0;
+  grown = realloc(*table, (*capacity ? *capacity * 2 : TEXT_MIN_ENTRIES) * size);
+  if (grown == NULL) return -1;
+  *table = grown;
+  *capacity = *capacity ? *capacity * 2 : TEXT_MIN_ENTRIES;
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642ParseText
+// Description  : Normalize a text: letters of either case become 0-25 and
+//                their uppercase in the canonical text, every other byte a
+//                separator and a space, recording the words and the offsets
+//                of the bytes that changed
+//
+// Inputs       : text - the place to put the normalized text
+//                original - the text to normalize, kept until it is freed
+//                len - the length of the text
+// Outputs      : 0 if successful, -1 if failure
+
+int cs642ParseText(cs642Text *text, const char *original, int len) {
+  int i, wordCapacity = 0, markCapacity = 0, inWord = 0;
+  unsigned int b, c;
+
+  memset(text, 0, sizeof(cs642Text));
+  text->original = original;
+  text->len = len;
+  text->canon = malloc(len + 1);
+  text->letters = malloc(len + 1);
+  if (text->canon == NULL || text->letters == NULL) goto failed;
+
+  for (i = 0; i < len; i++) {
+    b = (unsigned char)original[i];
+    // setting bit 5 folds 'A'-'Z' onto 'a'-'z' and no other byte lands there
+    c = (b | 0x20) - 'a';
+    if (c < KERNEL_NALPHA) {
+      text->letters[i] = c;
+      text->canon[i] = 'A' + c;
+      text->nletters++;
+      if (!inWord) {
+        if (growTable((void **)&text->words, text->nwords, &wordCapacity, sizeof(cs642Word)))
+          goto failed;
+        text->words[text->nwords].start = i;
+        text->words[text->nwords++].len = 0;
+        inWord = 1;
+      }
+      text->words[text->nwords - 1].len++;
+    } else {
+      text->letters[i] = LETTER_SPACE;
+      text->canon[i] = ' ';
+      inWord = 0;
+    }
+    if ((unsigned char)text->canon[i] != b) {
+      if (growTable((void **)&text->marks, text->nmarks, &markCapacity, sizeof(int)))
+        goto failed;
+      text->marks[text->nmarks++] = i;
+    }
+  }
+  text->canon[len] = '\0';
+  return (0);
+
+failed:
+  cs642FreeText(text);
+  return (-1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642RestoreText
+// Description  : Undo the normalization of a text on its plaintext: each
+//                changed byte that was a lowercase letter lowers the
+//                plaintext letter and any other one is copied back
+//
+// Inputs       : text - the normalized ciphertext
+//                plain - the plaintext decrypted from text->canon
+//                plen - the length of the plaintext buffer
+// Outputs      : none
+
+void cs642RestoreText(const cs642Text *text, char *plain, int plen) {
+  int i, off;
+
+  for (i = 0; i < text->nmarks && (off = text->marks[i]) < plen; i++) {
+    if (text->letters[off] == LETTER_SPACE) plain[off] = text->original[off];
+    else plain[off] |= 0x20;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Function     : cs642FreeText
+// Description  : Release the buffers of a normalized text
+//
+// Inputs       : text - the text to release
+// Outputs      : none
+
+void cs642FreeText(cs642Text *text) {
+  free(text->canon);
+  free(text->letters);
+  free(text->words);
+  free(text->marks);
+  memset(text, 0, sizeof(cs642Text));
+}
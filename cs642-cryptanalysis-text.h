@@ -0,0 +1,57 @@
+#ifndef CS642_CRYPTANALYSIS_TEXT_INCLUDED
+#define CS642_CRYPTANALYSIS_TEXT_INCLUDED
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  File           : cs642-cryptanalysis-text.h
+//  Description    : This is an include file to define the normalized form of
+//                   a ciphertext that every analyzer works on. One pass over
+//                   the raw text folds lowercase letters to uppercase, turns
+//                   any other byte into a word separator, and records where
+//                   the words are and which bytes were changed, so the
+//                   analyzers never look at the raw text again and the
+//                   original punctuation and case are put back on the
+//                   plaintext at output.
+//
+//   Author        : Sarthak Khattar
+//   Last Modified : 10-18-2026
+
+// Include Files
+#include <stdint.h>
+
+//
+// Type definitions
+
+// A word of a text, a maximal run of letters
+typedef struct cs642Word {
+  int start;                  // offset of its first letter
+  int len;
+} cs642Word;
+
+// A text normalized for the analyzers, offsets are the same as the original's
+typedef struct cs642Text {
+  const char *original;       // the text as given, not owned
+  int len;
+  char *canon;                // 'A'-'Z' and spaces only, len + 1 bytes
+  uint8_t *letters;           // letter indexes, 0-25 or LETTER_SPACE
+  int nletters;
+  cs642Word *words;           // the words in order
+  int nwords;
+  int *marks;                 // offsets of the bytes canon changed
+  int nmarks;
+} cs642Text;
+
+//
+// Text functions
+
+int cs642ParseText(cs642Text *text, const char *original, int len);
+// Normalize the len bytes of a text in one pass, 0 if successful
+
+void cs642RestoreText(const cs642Text *text, char *plain, int plen);
+// Put the case and non-letters of the original text back on a plaintext
+// decrypted from its canonical form
+
+void cs642FreeText(cs642Text *text);
+// Release a normalized text
+
+#endif
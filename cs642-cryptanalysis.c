@@ -15,19 +15,56 @@
 #include <unistd.h>
 
 // Project Include Files
-#include "cs642-cryptanalysis-impl.h"
 #include "cs642-cryptanalysis-support.h"
+#include "cs642-cryptanalysis-impl.h"
+#include "cs642-cryptanalysis-batch.h"
+#include "cs642-cryptanalysis-pool.h"
+#include "cs642-cryptanalysis-stats.h"
+#include "cs642-cryptanalysis-cache.h"
 
 // Defines
-#define cs642_CRYPTANALYSIS_ARGUMENTS "vuh"
+#define cs642_CRYPTANALYSIS_ARGUMENTS "vuhSs:r:i:t:j:k:c:f:Lw:m:e:p:R:q:"
 #define cs642_CRYPTANALYSIS_USAGE                                              \
   "\n"                                                                         \
-  "  cryptanalysis -c <cipher> [-v] [-u] [-h]\n\n"                             \
+  "  cryptanalysis -c <cipher> [-v] [-u] [-h] [-S] [-s <strategy>]\n"         \
+  "                [-r <rounds>] [-R <seed>]\n"                               \
+  "                [-i <iters>] [-t <ms>] [-j <threads>]\n"                    \
+  "                [-k <min>,<max>[,<top>]] [-f <file> [-L]] [-w <workers>]\n"  \
+  "                [-m <model>] [-q <mode>] [-e <entries>] [-p <file>]\n\n"  \
   "  where:\n"                                                                 \
+  "     -c - cipher of batch records without a tag (ROTX, VIGE or SUBS,\n"   \
+  "          or UNK, the default, to classify each record)\n"              \
+  "     -f - batch mode, analyze the ciphertexts of a file (- for stdin),\n"  \
+  "          one per line as [TAG:]<ciphertext>, writing CSV records of\n"   \
+  "          cipher,key,plaintext,score,latency to stdout (repeatable)\n"     \
+  "     -L - batch records are [TAG:]<length> lines followed by the bytes\n"  \
+  "     -w - batch records analyzed concurrently (0 for one per CPU)\n"     \
+  "     -m - language model file (default cs642-model.bin, see make model)\n"\
+  "     -q - n-gram scoring mode (float, or fixed for int16 fixed point)\n" \
+  "     -e - Vigenere and substitution results cached (0 to disable)\n"      \
+  "     -p - file the cached results are reloaded from and appended to\n"    \
   "     -u - runs the unit test (no cipher needed)\n"                          \
   "     -v - verbose mode (display all logging messages)\n"                    \
+  "     -S - log the time of each analysis phase and the search counters\n"    \
+  "     -s - substitution search strategy (hillclimb, anneal or tabu)\n"       \
+  "     -r - substitution search restarts\n" \
+  "     -R - substitution search seed, the n-th search using seed + n (a\n"  \
+  "          search logs its seed with -v, and replays it with -j 1)\n"      \
+  "     -i - substitution key evaluations per restart\n"                       \
+  "     -t - substitution search time budget in ms (0 for none)\n"             \
+  "     -j - substitution search threads per ciphertext (0 for one per CPU,\n" \
+  "          or one when several batch records are analyzed concurrently)\n"\
+  "     -k - Vigenere key lengths searched, and how many best ranked are\n"    \
+  "          solved\n"                                                         \
   "     -h - displays this help message, and returns\n\n"
 #define CS642_CRYPTANALYSIS_TESTS 3
+#define CS642_SUBS_ROUNDS 10
+#define CS642_SUBS_ITERS 5000
+#define CS642_VIGE_MIN_KEYSIZE 6
+#define CS642_VIGE_MAX_KEYSIZE 11
+#define CS642_VIGE_TOPK 3
+#define CS642_MAX_BATCH_FILES 64
+#define CS642_SUBS_KEYSIZE 26
 
 // This is the file table
 
@@ -35,6 +72,7 @@
 // Global Data
 int cs642Verbose = 0;
 uint32_t CipherVerboseLevel;
+uint32_t CipherStatsLevel;
 
 //
 // Functions
@@ -51,9 +89,23 @@ uint32_t CipherVerboseLevel;
 int main(int argc, char *argv[]) {
 
   // Local variables
-  int ch, log_initialized = 0, unit_tests = 0, keylen, i, clen;
+  int ch, log_initialized = 0, unit_tests = 0, stats = 0, keylen, i, clen;
+  int subsRounds = CS642_SUBS_ROUNDS, subsIters = CS642_SUBS_ITERS;
+  int subsTimeMs = 0, subsThreads = 0;
+  uint64_t subsSeed = 0;
+  int vigeMin = CS642_VIGE_MIN_KEYSIZE, vigeMax = CS642_VIGE_MAX_KEYSIZE;
+  int vigeTopk = CS642_VIGE_TOPK;
+  int batchFiles = 0, batchFailed = 0, lengthDelimited = 0, workers = 0;
+  int cacheEntries = CS642_CACHE_ENTRIES;
+  char *cachePath = NULL;
+  char *batchPaths[CS642_MAX_BATCH_FILES];
+  FILE *batchIn;
+  cs642BatchConfig batch;
   char *ciphertext, *plaintext, *key;
-  cs642Cipher cipher = CIPHER_UNK;
+  cs642Cipher cipher = CIPHER_UNK, order[CIPHER_UNK];
+  cs642SubsStrategy strategy = SUBS_HILLCLIMB;
+  cs642ScoreMode scoreMode = CS642_SCORE_FLOAT;
+  cs642Pool *pool = NULL;
 
   // Process the command line parameters
   while ((ch = getopt(argc, argv, cs642_CRYPTANALYSIS_ARGUMENTS)) != -1) {
@@ -66,6 +118,98 @@ int main(int argc, char *argv[]) {
       unit_tests = 1;
       break;
 
+    case 'S': // Instrumentation summary
+      stats = 1;
+      break;
+
+    case 's': // Substitution search strategy
+      for (strategy = SUBS_HILLCLIMB; strategy < SUBS_STRATEGY_MAX; strategy++) {
+        if (strcmp(optarg, cs642SubsStrategyStrings[strategy]) == 0)
+          break;
+      }
+      if (strategy == SUBS_STRATEGY_MAX) {
+        fprintf(stderr, "Unknown substitution strategy (%s), aborting.\n", optarg);
+        return (-1);
+      }
+      break;
+
+    case 'r': // Substitution search restarts
+      subsRounds = atoi(optarg);
+      break;
+
+    case 'R': // Substitution search seed
+      subsSeed = strtoull(optarg, NULL, 10);
+      break;
+
+    case 'i': // Substitution key evaluations per restart
+      subsIters = atoi(optarg);
+      break;
+
+    case 't': // Substitution search time budget
+      subsTimeMs = atoi(optarg);
+      break;
+
+    case 'j': // Substitution search threads
+      subsThreads = atoi(optarg);
+      break;
+
+    case 'k': // Vigenere key lengths
+      if (sscanf(optarg, "%d,%d,%d", &vigeMin, &vigeMax, &vigeTopk) < 2) {
+        fprintf(stderr, "Bad Vigenere key lengths (%s), aborting.\n", optarg);
+        return (-1);
+      }
+      break;
+
+    case 'c': // Cipher of untagged batch records
+      if (cs642ParseCipher(optarg, &cipher)) {
+        fprintf(stderr, "Unknown cipher (%s), aborting.\n", optarg);
+        return (-1);
+      }
+      break;
+
+    case 'f': // Batch input file
+      if (batchFiles == CS642_MAX_BATCH_FILES) {
+        fprintf(stderr, "Too many batch files, aborting.\n");
+        return (-1);
+      }
+      batchPaths[batchFiles++] = optarg;
+      break;
+
+    case 'L': // Length delimited batch records
+      lengthDelimited = 1;
+      break;
+
+    case 'w': // Ciphertexts analyzed concurrently
+      workers = atoi(optarg);
+      if (workers < 0) {
+        fprintf(stderr, "Bad number of workers (%s), aborting.\n", optarg);
+        return (-1);
+      }
+      break;
+
+    case 'm': // Language model file
+      cs642SetModelFile(optarg);
+      break;
+
+    case 'q': // Scoring mode
+      for (scoreMode = CS642_SCORE_FLOAT; scoreMode < CS642_SCORE_MAX; scoreMode++) {
+        if (strcmp(optarg, cs642ScoreModeStrings[scoreMode]) == 0)
+          break;
+      }
+      if (scoreMode == CS642_SCORE_MAX) {
+        fprintf(stderr, "Unknown scoring mode (%s), aborting.\n", optarg);
+        return (-1);
+      }
+      break;
+
+    case 'e': // Cached results
+      cacheEntries = atoi(optarg);
+      break;
+
+    case 'p': // Cache file
+      cachePath = optarg;
+      break;
+
     case 'h': // Help Flag
       fprintf(stderr, cs642_CRYPTANALYSIS_USAGE);
       return (0);
@@ -76,16 +220,48 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  // Setup the log as needed
+  // Batch records run concurrently on the pool, so unless asked otherwise
+  // each substitution search keeps to one thread rather than one per CPU
+  if (workers == 0)
+    workers = sysconf(_SC_NPROCESSORS_ONLN);
+  if (workers < 1)
+    workers = 1;
+  if (batchFiles && workers > 1 && subsThreads == 0)
+    subsThreads = 1;
+
+  // Configure the substitution search
+  if (cs642SetSUBSSearch(strategy, subsRounds, subsIters, subsTimeMs,
+                         subsThreads)) {
+    fprintf(stderr, "Invalid substitution search settings, aborting.\n");
+    return (-1);
+  }
+  cs642SetSUBSSeed(subsSeed);
+  cs642SetScoreMode(scoreMode);
+  if (cs642SetVIGESearch(vigeMin, vigeMax, vigeTopk)) {
+    fprintf(stderr, "Invalid Vigenere search settings, aborting.\n");
+    return (-1);
+  }
+  if (cs642SetCache(cacheEntries, cachePath)) {
+    fprintf(stderr, "Invalid result cache settings, aborting.\n");
+    return (-1);
+  }
+
+  // Setup the log as needed, batch mode keeps stdout for its records
   if (!log_initialized) {
-    initializeLogWithFilehandle(COMPSCI642_LOG_STDOUT);
+    initializeLogWithFilehandle(batchFiles ? COMPSCI642_LOG_STDERR
+                                           : COMPSCI642_LOG_STDOUT);
   }
   CipherVerboseLevel =
       registerLogLevel("CipherVerboseLevel", 0); // Controller log level
+  CipherStatsLevel =
+      registerLogLevel("CipherStatsLevel", 0); // Instrumentation summary
   if (cs642Verbose) {
     enableLogLevels(LOG_INFO_LEVEL);
     enableLogLevels(CipherVerboseLevel);
   }
+  if (cs642Verbose || stats) {
+    enableLogLevels(CipherStatsLevel);
+  }
 
   // Run the unit tests
   if (unit_tests) {
@@ -109,7 +285,36 @@ int main(int argc, char *argv[]) {
       logMessage(LOG_OUTPUT_LEVEL, "cs642StudentInit succeeded");
     }
 
-    for (cipher = CIPHER_ROTX; cipher < CIPHER_UNK; cipher++) {
+    // Start the workers the batch records are analyzed on
+    if (batchFiles && (pool = cs642CreatePool(workers)) == NULL) {
+      logMessage(LOG_ERROR_LEVEL, "Cannot start the worker pool, aborting.");
+      exit(-1);
+    }
+
+    // Stream the batch files through the analyzers, in place of the samples
+    batch.defaultCipher = cipher;
+    batch.lengthDelimited = lengthDelimited;
+    batch.keySize = vigeMax > CS642_SUBS_KEYSIZE ? vigeMax : CS642_SUBS_KEYSIZE;
+    batch.pool = pool;
+    for (i = 0; i < batchFiles; i++) {
+      batchIn = strcmp(batchPaths[i], "-") ? fopen(batchPaths[i], "r") : stdin;
+      if (batchIn == NULL) {
+        logMessage(LOG_ERROR_LEVEL, "Cannot open batch file (%s), aborting.",
+                   batchPaths[i]);
+        exit(-1);
+      }
+      if (cs642RunBatch(batchIn, &batch)) {
+        logMessage(LOG_ERROR_LEVEL, "Batch file (%s) had failed records.",
+                   batchPaths[i]);
+        batchFailed = 1;
+      }
+      if (batchIn != stdin) fclose(batchIn);
+    }
+    cs642DestroyPool(pool);
+
+    // The samples run one at a time, the support library only checks the
+    // plaintext of the most recent sample
+    for (cipher = CIPHER_ROTX; batchFiles == 0 && cipher < CIPHER_UNK; cipher++) {
       for (i = 0; i < CS642_CRYPTANALYSIS_TESTS; i++) {
 
         // Get the ciphertext, create space for key and plaintext
@@ -118,27 +323,22 @@ int main(int argc, char *argv[]) {
         plaintext = malloc(clen + 1);
         memset(plaintext, 0x00, clen + 1);
         keylen = cs642GetCipherKeyLength(cipher);
+        if (cipher == CIPHER_VIGE && keylen < vigeMax)
+          keylen = vigeMax;
         key = malloc(keylen + 1);
         memset(key, 0x00, keylen + 1);
 
-        // Perform the cryptanalysis
-        switch (cipher) {
-        case CIPHER_ROTX:
-          cs642PerformROTXCryptanalysis(ciphertext, clen, plaintext, clen,
-                                        (uint8_t *)key);
-          break;
-        case CIPHER_VIGE:
-          cs642PerformVIGECryptanalysis(ciphertext, clen, plaintext, clen, key);
-          break;
-        case CIPHER_SUBS:
-          cs642PerformSUBSCryptanalysis(ciphertext, clen, plaintext, clen, key);
-          break;
-        default:
-          logMessage(LOG_ERROR_LEVEL, "Unknown cipher (%d) in cryptanalysis.",
-                     cipher);
-          break;
+        // Check the classifier against the known cipher
+        if (cs642ClassifyCiphertext(ciphertext, clen, order) != cipher) {
+          logMessage(CipherVerboseLevel,
+                     "Sample %d/%d of cipher (%s) classified as (%s).", i + 1,
+                     CS642_CRYPTANALYSIS_TESTS, cs642CipherStrings[cipher],
+                     cs642CipherStrings[order[0]]);
         }
 
+        // Perform the cryptanalysis
+        cs642AnalyzeCiphertext(cipher, ciphertext, clen, plaintext, key);
+
         // Now check result
         if (cs642CheckPlaintext(cipher, plaintext, ciphertext, key)) {
           logMessage(
@@ -161,6 +361,7 @@ int main(int argc, char *argv[]) {
         ciphertext = NULL;
       }
     }
+    cs642LogStats(CipherStatsLevel);
     cs642CleanCipherStructures(); // Clean up the cipher structures
     if (cs642StudentCleanUp()) {
       logMessage(LOG_ERROR_LEVEL,
@@ -169,6 +370,10 @@ int main(int argc, char *argv[]) {
     } else {
       logMessage(LOG_OUTPUT_LEVEL, "cs642StudentCleanUp succeeded");
     }
+    if (batchFiles) {
+      logMessage(LOG_OUTPUT_LEVEL, "*** Batch cryptanalysis complete. ***");
+      return (batchFailed ? -1 : 0);
+    }
     logMessage(LOG_OUTPUT_LEVEL,
                "*** All Cryptanalysis succeeded, assignment complete!!! ***.");
   }